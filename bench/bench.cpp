@@ -0,0 +1,453 @@
+/*
+ *  Host benchmarks for the library core.
+ *
+ *  Every benchmark prints one JSON object per line:
+ *    {"name":"sha256","size":64,"iterations":262144,"ns_per_op":231.5,"ops_per_s":4319654,"mb_per_s":276.5}
+ *  size is the input length in bytes or the number of transaction inputs/outputs,
+ *  mb_per_s is only present when the benchmark processes a byte count.
+ *
+ *  Usage: bench [--quick] [--time seconds] [filter]
+ *    --quick    short time budget, for smoke tests
+ *    --time     minimal measured time per benchmark, 0.25 s by default
+ *    filter     runs only benchmarks whose name contains this substring
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Bitcoin.h"
+#include "Hash.h"
+#include "Conversion.h"
+#include "OpCodes.h"
+#include "utility/segwit_addr.h"
+
+static double minTime = 0.25;
+static const char * filter = NULL;
+static volatile uint8_t sink; // keeps results alive
+
+static double now(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// runs fn until it takes at least minTime and prints the result
+template<typename F>
+static void run(const char * name, size_t size, size_t bytes, F fn){
+    if(filter != NULL && strstr(name, filter) == NULL){
+        return;
+    }
+    uint64_t iterations = 1;
+    double elapsed = 0;
+    while(true){
+        double start = now();
+        for(uint64_t i = 0; i < iterations; i++){
+            fn();
+        }
+        elapsed = now() - start;
+        if(elapsed >= minTime){
+            break;
+        }
+        // aim slightly above minTime, but never grow more than 100x at once
+        double scale = (elapsed > 0) ? (minTime * 1.2 / elapsed) : 100;
+        if(scale > 100){
+            scale = 100;
+        }
+        if(scale < 2){
+            scale = 2;
+        }
+        iterations = (uint64_t)(iterations * scale);
+    }
+    double ns = elapsed * 1e9 / iterations;
+    printf("{\"name\":\"%s\",\"size\":%zu,\"iterations\":%llu,\"ns_per_op\":%.1f,\"ops_per_s\":%.0f",
+           name, size, (unsigned long long)iterations, ns, 1e9 / ns);
+    if(bytes > 0){
+        printf(",\"mb_per_s\":%.1f", bytes * 1e3 / ns);
+    }
+    printf("}\n");
+    fflush(stdout);
+}
+
+static void fill(uint8_t * buf, size_t len, uint32_t seed){
+    for(size_t i = 0; i < len; i++){
+        seed = seed * 1103515245 + 12345;
+        buf[i] = seed >> 16;
+    }
+}
+
+static void benchHashes(){
+    static const size_t sizes[] = { 32, 64, 1024, 16384 };
+    static uint8_t data[16384];
+    fill(data, sizeof(data), 1);
+    for(size_t k = 0; k < sizeof(sizes)/sizeof(sizes[0]); k++){
+        size_t len = sizes[k];
+        run("sha256", len, len, [&](){
+            uint8_t h[32];
+            sha256(data, len, h);
+            sink = h[0];
+        });
+        run("sha512", len, len, [&](){
+            uint8_t h[64];
+            sha512(data, len, h);
+            sink = h[0];
+        });
+        run("ripemd160", len, len, [&](){
+            uint8_t h[20];
+            rmd160(data, len, h);
+            sink = h[0];
+        });
+        run("hash160", len, len, [&](){
+            uint8_t h[20];
+            hash160(data, len, h);
+            sink = h[0];
+        });
+        run("doubleSha", len, len, [&](){
+            uint8_t h[32];
+            doubleSha(data, len, h);
+            sink = h[0];
+        });
+    }
+    run("hmac_sha512", 64, 64, [&](){
+        uint8_t h[64];
+        sha512Hmac(data, 32, data + 32, 64, h);
+        sink = h[0];
+    });
+    run("pbkdf2_hmac_sha512_2048", 64, 0, [&](){
+        uint8_t seed[64];
+        pbkdf2_hmac_sha512(data, 48, data + 48, 16, 2048, seed, sizeof(seed));
+        sink = seed[0];
+    });
+}
+
+static void benchEncodings(){
+    // 21-byte address payload and 78-byte extended key
+    static const size_t sizes[] = { 21, 78 };
+    uint8_t data[128];
+    fill(data, sizeof(data), 2);
+    data[0] = 0x00; // leading zero, as in mainnet P2PKH
+    for(size_t k = 0; k < sizeof(sizes)/sizeof(sizes[0]); k++){
+        size_t len = sizes[k];
+        char encoded[200];
+        toBase58Check(data, len, encoded, sizeof(encoded));
+        size_t encodedLen = strlen(encoded);
+        run("base58check_encode", len, len, [&](){
+            char out[200];
+            toBase58Check(data, len, out, sizeof(out));
+            sink = out[0];
+        });
+        run("base58check_decode", len, len, [&](){
+            uint8_t out[128];
+            sink = fromBase58Check(encoded, encodedLen, out, sizeof(out));
+        });
+        run("hex_encode", len, len, [&](){
+            char out[300];
+            toHex(data, len, out, sizeof(out));
+            sink = out[0];
+        });
+    }
+    // raw transactions dumped and read over RPC
+    static const size_t hexSizes[] = { 1024, 262144 };
+    static uint8_t big[262144];
+    static char bigHex[2 * 262144 + 1];
+    fill(big, sizeof(big), 7);
+    for(size_t k = 0; k < sizeof(hexSizes)/sizeof(hexSizes[0]); k++){
+        size_t len = hexSizes[k];
+        run("hex_encode", len, len, [&](){
+            toHex(big, len, bigHex, 2 * len + 1);
+            sink = bigHex[0];
+        });
+        run("hex_decode", len, len, [&](){
+            sink = fromHex(bigHex, 2 * len, big, len);
+        });
+        run("hex_decode_strict", len, len, [&](){
+            sink = fromHexStrict(bigHex, 2 * len, big, len);
+        });
+    }
+    static const size_t progs[] = { 20, 32 };
+    for(size_t k = 0; k < sizeof(progs)/sizeof(progs[0]); k++){
+        size_t len = progs[k];
+        char addr[100];
+        segwit_addr_encode(addr, "bc", 0, data, len);
+        run("bech32_encode", len, len, [&](){
+            char out[100];
+            segwit_addr_encode(out, "bc", 0, data, len);
+            sink = out[4];
+        });
+        run("bech32_decode", len, len, [&](){
+            int ver;
+            uint8_t prog[40];
+            size_t progLen;
+            sink = segwit_addr_decode(&ver, prog, &progLen, "bc", addr);
+        });
+        // 64 programs of a watch-only batch into one buffer
+        static uint8_t progsBuf[64 * 32];
+        static char many[64 * 64];
+        fill(progsBuf, sizeof(progsBuf), 8);
+        run("bech32_encode_many", len, 64 * len, [&](){
+            sink = segwit_addr_encode_many(many, 64, "bc", 0, progsBuf, len, 64);
+        });
+    }
+}
+
+static void benchKeys(){
+    uint8_t secret[32];
+    fill(secret, sizeof(secret), 3);
+    uint8_t hash[32];
+    fill(hash, sizeof(hash), 4);
+    PrivateKey pk(secret);
+    PublicKey pub = pk.publicKey();
+    Signature sig = pk.sign(hash);
+
+    run("keygen", 32, 0, [&](){
+        secret[0]++;
+        PrivateKey key(secret);
+        sink = key.publicKey().point[0];
+    });
+    run("sign", 32, 0, [&](){
+        Signature s = pk.sign(hash);
+        sink = s.index;
+    });
+    run("verify", 32, 0, [&](){
+        sink = pub.verify(sig, hash);
+    });
+    run("address_p2wpkh", 33, 0, [&](){
+        char addr[100];
+        pub.segwitAddress(addr, sizeof(addr));
+        sink = addr[4];
+    });
+}
+
+static void benchHD(){
+    uint8_t seed[64];
+    fill(seed, sizeof(seed), 5);
+    HDPrivateKey root;
+    root.fromSeed(seed, sizeof(seed), false);
+    HDPrivateKey account = root.hardenedChild(84).hardenedChild(0).hardenedChild(0);
+    HDPublicKey xpub = account.xpub().c_str();
+    uint32_t index = 0;
+
+    run("bip32_private_child", 1, 0, [&](){
+        HDPrivateKey child = account.child(index++);
+        sink = child.chainCode[0];
+    });
+    run("bip32_private_hardened_child", 1, 0, [&](){
+        HDPrivateKey child = account.hardenedChild(index++);
+        sink = child.chainCode[0];
+    });
+    run("bip32_public_child", 1, 0, [&](){
+        HDPublicKey child = xpub.child(index++);
+        sink = child.chainCode[0];
+    });
+    HDPublicKey children[16];
+    run("bip32_public_children", 16, 0, [&](){
+        xpub.children(index, 16, children);
+        index += 16;
+        sink = children[0].chainCode[0];
+    });
+    run("bip32_derive_path", 5, 0, [&](){
+        HDPrivateKey key = root.derive("m/84h/0h/0h/0/1");
+        sink = key.chainCode[0];
+    });
+    const char * mnemonic = "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about";
+    run("bip39_mnemonic_to_key", 12, 0, [&](){
+        HDPrivateKey key;
+        key.fromMnemonic(mnemonic, strlen(mnemonic), "", 0);
+        sink = key.chainCode[0];
+    });
+}
+
+// transaction with n inputs and n outputs, P2PKH-sized scripts
+static size_t makeTransaction(size_t n, bool segwit, uint8_t * raw, size_t len){
+    Transaction tx;
+    uint8_t buf[107];
+    for(size_t i = 0; i < n; i++){
+        TransactionInput * txIn = tx.emplaceInput();
+        fill(txIn->hash, 32, i);
+        txIn->outputIndex = i % 4;
+        txIn->amount = 100000 + i;
+        if(segwit){
+            fill(buf, sizeof(buf), i + 1000);
+            txIn->witnessProgram.push(2);
+            txIn->witnessProgram.push(72);
+            txIn->witnessProgram.push(buf, 72);
+            txIn->witnessProgram.push(33);
+            txIn->witnessProgram.push(buf + 72, 33);
+        }else{
+            fill(buf, sizeof(buf), i + 1000);
+            buf[0] = 71;
+            buf[72] = 33;
+            txIn->scriptSig = Script(buf, sizeof(buf) - 1);
+        }
+    }
+    for(size_t i = 0; i < n; i++){
+        TransactionOutput * txOut = tx.emplaceOutput();
+        txOut->amount = 50000 + i;
+        fill(buf, 20, i + 2000);
+        txOut->scriptPubKey.push(OP_DUP);
+        txOut->scriptPubKey.push(OP_HASH160);
+        txOut->scriptPubKey.push(20);
+        txOut->scriptPubKey.push(buf, 20);
+        txOut->scriptPubKey.push(OP_EQUALVERIFY);
+        txOut->scriptPubKey.push(OP_CHECKSIG);
+    }
+    return tx.serialize(raw, len);
+}
+
+static void benchTransactions(){
+    static const size_t sizes[] = { 1, 10, 100 };
+    static uint8_t raw[40000];
+    static uint8_t out[40000];
+    uint8_t secret[32];
+    fill(secret, sizeof(secret), 6);
+    PrivateKey pk(secret);
+    Script scriptPubKey = pk.publicKey().script();
+
+    for(size_t k = 0; k < sizeof(sizes)/sizeof(sizes[0]); k++){
+        size_t n = sizes[k];
+        size_t len = makeTransaction(n, false, raw, sizeof(raw));
+        Transaction tx(raw, len);
+
+        run("tx_parse", n, len, [&](){
+            Transaction t(raw, len);
+            sink = t.inputsNumber;
+        });
+        run("tx_view_parse", n, len, [&](){
+            TransactionView view(raw, len);
+            sink = view.inputsNumber;
+        });
+        // reads every input and output in order
+        run("tx_view_iterate", n, len, [&](){
+            TransactionView view(raw, len);
+            uint32_t sum = 0;
+            for(size_t i = 0; i < view.inputsNumber; i++){
+                sum += view.input(i).sequence;
+            }
+            for(size_t i = 0; i < view.outputsNumber; i++){
+                sum += view.output(i).amount;
+            }
+            sink = sum;
+        });
+        run("tx_serialize", n, len, [&](){
+            sink = tx.serialize(out, sizeof(out));
+        });
+        run("tx_id", n, len, [&](){
+            uint8_t h[32];
+            tx.hash(h);
+            sink = h[0];
+        });
+        // sighashes of all inputs
+        run("tx_sighash_legacy", n, 0, [&](){
+            uint8_t h[32];
+            tx.clearSigHashCache();
+            tx.precomputeSigHash();
+            for(size_t i = 0; i < n; i++){
+                tx.sigHash(i, scriptPubKey, h);
+            }
+            sink = h[0];
+        });
+
+        len = makeTransaction(n, true, raw, sizeof(raw));
+        Transaction segwitTx(raw, len);
+        for(size_t i = 0; i < n; i++){
+            segwitTx.txIns[i].amount = 100000 + i;
+        }
+        run("tx_parse_segwit", n, len, [&](){
+            Transaction t(raw, len);
+            sink = t.inputsNumber;
+        });
+        run("tx_sighash_segwit", n, 0, [&](){
+            uint8_t h[32];
+            segwitTx.clearSigHashCache();
+            segwitTx.precomputeSigHash();
+            for(size_t i = 0; i < n; i++){
+                segwitTx.sigHashSegwit(i, scriptPubKey, h);
+            }
+            sink = h[0];
+        });
+
+        // signs all inputs of a P2WPKH transaction
+        static PrivateKey keys[100];
+        static Script scripts[100];
+        for(size_t i = 0; i < n; i++){
+            keys[i] = pk;
+            scripts[i] = pk.publicKey().script(P2WPKH);
+        }
+        run("tx_sign_all", n, 0, [&](){
+            sink = segwitTx.signAll(keys, scripts, 1);
+        });
+        run("tx_sign_all_4_threads", n, 0, [&](){
+            sink = segwitTx.signAll(keys, scripts, 4);
+        });
+    }
+}
+
+// verifies all inputs of a nested P2WPKH transaction, signatures
+// are checked with ECDSA or found in a cache sized by the caller
+static void benchVerify(){
+    static const size_t sizes[] = { 1, 10, 100, 1000 };
+    uint8_t secret[32];
+    fill(secret, sizeof(secret), 9);
+    PrivateKey pk(secret);
+    Script redeemScript = pk.publicKey().script(P2WPKH);
+    Script scriptPubKey = redeemScript.scriptPubkey();
+
+    for(size_t k = 0; k < sizeof(sizes)/sizeof(sizes[0]); k++){
+        size_t n = sizes[k];
+        Transaction tx;
+        static PrivateKey keys[1000];
+        static Script scripts[1000];
+        for(size_t i = 0; i < n; i++){
+            TransactionInput * txIn = tx.emplaceInput();
+            fill(txIn->hash, 32, i);
+            txIn->outputIndex = i % 4;
+            txIn->amount = 100000 + i;
+            keys[i] = pk;
+            scripts[i] = redeemScript;
+        }
+        TransactionOutput * txOut = tx.emplaceOutput();
+        txOut->amount = 50000;
+        txOut->scriptPubKey = scriptPubKey;
+        tx.signAll(keys, scripts, 1);
+        // sighash data is shared by all inputs
+        tx.precomputeSigHash();
+
+        run("tx_verify", n, 0, [&](){
+            size_t valid = 0;
+            for(size_t i = 0; i < n; i++){
+                valid += tx.verifyInput(i, scriptPubKey);
+            }
+            sink = valid;
+        });
+        // room for every signature, first pass fills the cache
+        SignatureCache cache(2 * n);
+        run("tx_verify_cached", n, 0, [&](){
+            size_t valid = 0;
+            for(size_t i = 0; i < n; i++){
+                valid += tx.verifyInput(i, scriptPubKey, &cache);
+            }
+            sink = valid;
+        });
+    }
+}
+
+int main(int argc, char ** argv){
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "--quick") == 0){
+            minTime = 0.002;
+        }else if(strcmp(argv[i], "--time") == 0 && i + 1 < argc){
+            minTime = atof(argv[++i]);
+        }else if(argv[i][0] == '-'){
+            fprintf(stderr, "usage: %s [--quick] [--time seconds] [filter]\n", argv[0]);
+            return 1;
+        }else{
+            filter = argv[i];
+        }
+    }
+    benchHashes();
+    benchEncodings();
+    benchKeys();
+    benchHD();
+    benchTransactions();
+    benchVerify();
+    return 0;
+}
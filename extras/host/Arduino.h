@@ -0,0 +1,124 @@
+/*
+ *  Minimal Arduino core for building the library on a workstation.
+ *  Provides only what src/ uses: byte, String, Print, Printable and Stream.
+ *  Not used by the Arduino IDE, see CMakeLists.txt in the root of the repo.
+ */
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+
+#include <string>
+
+typedef uint8_t byte;
+
+class String{
+    std::string s;
+public:
+    String(){}
+    String(const char * cstr){ if(cstr != NULL){ s = cstr; } }
+    String(const std::string &str): s(str){}
+    explicit String(char c): s(1, c){}
+    explicit String(int v): s(std::to_string(v)){}
+    explicit String(unsigned int v): s(std::to_string(v)){}
+    explicit String(long v): s(std::to_string(v)){}
+    explicit String(unsigned long v): s(std::to_string(v)){}
+
+    unsigned int length() const{ return s.size(); }
+    const char * c_str() const{ return s.c_str(); }
+    char charAt(unsigned int i) const{ return (i < s.size()) ? s[i] : 0; }
+    char operator[](unsigned int i) const{ return charAt(i); }
+    void toCharArray(char * buf, unsigned int len) const{
+        if(len == 0){
+            return;
+        }
+        size_t n = (s.size() < len - 1) ? s.size() : len - 1;
+        memcpy(buf, s.data(), n);
+        buf[n] = 0;
+    }
+    void getBytes(unsigned char * buf, unsigned int len) const{ toCharArray((char *)buf, len); }
+    bool reserve(unsigned int size){ s.reserve(size); return true; }
+    bool concat(const String &str){ s += str.s; return true; }
+    bool concat(const char * cstr){ if(cstr != NULL){ s += cstr; } return true; }
+    bool concat(char c){ s += c; return true; }
+    String substring(unsigned int from) const{ return (from < s.size()) ? String(s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const{
+        if(from > to){ unsigned int t = from; from = to; to = t; }
+        return (from < s.size()) ? String(s.substr(from, to - from)) : String();
+    }
+    int indexOf(char c) const{ size_t i = s.find(c); return (i == std::string::npos) ? -1 : (int)i; }
+
+    String &operator+=(const String &str){ concat(str); return *this; }
+    String &operator+=(const char * cstr){ concat(cstr); return *this; }
+    String &operator+=(char c){ concat(c); return *this; }
+    friend String operator+(const String &a, const String &b){ return String(a.s + b.s); }
+    friend String operator+(const String &a, const char * b){ return String(a.s + b); }
+    friend String operator+(const char * a, const String &b){ return String(a + b.s); }
+    bool operator==(const String &other) const{ return s == other.s; }
+    bool operator!=(const String &other) const{ return s != other.s; }
+    bool operator==(const char * cstr) const{ return s == cstr; }
+    bool operator!=(const char * cstr) const{ return s != cstr; }
+};
+
+class Print;
+
+class Printable{
+public:
+    virtual ~Printable(){}
+    virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print{
+public:
+    virtual ~Print(){}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t * buffer, size_t size){
+        size_t n = 0;
+        while(size--){
+            n += write(*buffer++);
+        }
+        return n;
+    }
+    size_t write(const char * str){ return (str == NULL) ? 0 : write((const uint8_t *)str, strlen(str)); }
+
+    size_t print(const char * str){ return write(str); }
+    size_t print(char c){ return write((uint8_t)c); }
+    size_t print(const String &str){ return write((const uint8_t *)str.c_str(), str.length()); }
+    size_t print(int v){ return print(String(v)); }
+    size_t print(unsigned int v){ return print(String(v)); }
+    size_t print(long v){ return print(String(v)); }
+    size_t print(unsigned long v){ return print(String(v)); }
+    size_t print(const Printable &p){ return p.printTo(*this); }
+    size_t println(){ return write('\n'); }
+    template<typename T> size_t println(const T &v){ size_t n = print(v); return n + println(); }
+};
+
+class Stream : public Print{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush(){}
+    size_t readBytes(uint8_t * buffer, size_t length){
+        size_t n = 0;
+        while(n < length){
+            int c = read();
+            if(c < 0){
+                break;
+            }
+            buffer[n++] = (uint8_t)c;
+        }
+        return n;
+    }
+    size_t readBytes(char * buffer, size_t length){ return readBytes((uint8_t *)buffer, length); }
+};
+
+#endif /* __cplusplus */
+
+#endif /* HOST_ARDUINO_H */
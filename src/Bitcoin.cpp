@@ -387,6 +387,28 @@ bool PublicKey::verify(const Signature sig, const uint8_t hash[32]) const{
     const struct uECC_Curve_t * curve = uECC_secp256k1();
     return uECC_verify(point, hash, 32, signature, curve);
 }
+size_t PublicKey::verifyBatch(const PublicKey * pubkeys, const Signature * sigs, const uint8_t (*hashes)[32], size_t n, bool * valid){
+    const size_t chunk = 16;
+    uint8_t points[chunk][64];
+    uint8_t signatures[chunk][64];
+    uint8_t results[chunk];
+    const struct uECC_Curve_t * curve = uECC_secp256k1();
+    size_t count = 0;
+    for(size_t i = 0; i < n; i += chunk){
+        size_t len = (n - i < chunk) ? (n - i) : chunk;
+        for(size_t j = 0; j < len; j++){
+            memcpy(points[j], pubkeys[i+j].point, 64);
+            sigs[i+j].bin(signatures[j]);
+        }
+        count += uECC_verify_batch(points[0], hashes[i], 32, signatures[0], len, results, curve);
+        if(valid != NULL){
+            for(size_t j = 0; j < len; j++){
+                valid[i+j] = results[j];
+            }
+        }
+    }
+    return count;
+}
 PublicKey::operator String(){ 
     uint8_t arr[65] = { 0 };
     int len = sec(arr, sizeof(arr));
@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <string.h>
 #include "Conversion.h"
+#include "Hash.h"
 
 /*
     Constants.
@@ -37,6 +38,43 @@
 #define P2SH_P2WPKH            5
 #define P2SH_P2WSH             6
 
+// Derivation paths
+#define HARDENED_INDEX         0x80000000
+// maximum depth of a path accepted by derive()
+#ifndef HD_MAX_PATH_DEPTH
+#define HD_MAX_PATH_DEPTH      16
+#endif
+// number of keys kept by HDPrivateKeyCache / HDPublicKeyCache
+#ifndef HD_CACHE_SIZE
+#define HD_CACHE_SIZE          8
+#endif
+// children derived at once by HDPublicKey::children() and addresses(),
+// each one takes about 200 bytes of stack
+#ifndef CHILDREN_BATCH
+#if defined(__AVR__)
+#define CHILDREN_BATCH         4
+#else
+#define CHILDREN_BATCH         16
+#endif
+#endif
+// default number of signatures kept by SignatureCache (32 bytes each)
+// and slots checked for every entry
+#ifndef SIG_CACHE_SIZE
+#if defined(__AVR__)
+#define SIG_CACHE_SIZE         32
+#else
+#define SIG_CACHE_SIZE         1024
+#endif
+#endif
+#ifndef SIG_CACHE_WAYS
+#define SIG_CACHE_WAYS         4
+#endif
+// Transaction::signAll() uses pthread workers when set to 1,
+// boards without threads sign inputs one by one
+#ifndef BITCOIN_THREADS
+#define BITCOIN_THREADS        0
+#endif
+
 // SigHash types
 #define SIGHASH_ALL            1
 #define SIGHASH_NONE           2
@@ -44,6 +82,9 @@
 
 
 class PublicKey; // forward definition
+class HDPrivateKeyCache;
+class HDPublicKeyCache;
+class SignatureCache;
 
 /*
     Signature class.
@@ -109,22 +150,48 @@ public:
 
 /* 
  *  Script class
+ *  Scripts up to SCRIPT_INLINE_SIZE bytes (all standard output scripts,
+ *  on AVR only P2PKH, P2SH and P2WPKH to save RAM) are stored inside
+ *  the object, longer ones on the heap or in the arena.
  */
 
+#ifndef SCRIPT_INLINE_SIZE
+#if defined(__AVR__)
+#define SCRIPT_INLINE_SIZE 25
+#else
+#define SCRIPT_INLINE_SIZE 40
+#endif
+#endif
+
 class Script : public Printable{
+    friend class Transaction;                                 // interpreter reads scripts in place
 private:
     void clear();                                             // clears memory
-    uint8_t * scriptArray = NULL;                             // stores actual script data
+    bool allocate(size_t len);                                // prepares zeroed storage for len bytes
+    bool reserve(size_t len);                                 // grows storage keeping first scriptLen bytes
+    bool ownsHeap() const;                                    // scriptArray is on the heap
+    size_t capacity() const{ return (scriptArray != NULL) ? scriptCapacity : SCRIPT_INLINE_SIZE; };
+    uint8_t * data(){ return (scriptArray != NULL) ? scriptArray : inlineArray; };
+    const uint8_t * data() const{ return (scriptArray != NULL) ? scriptArray : inlineArray; };
+    uint8_t * scriptArray = NULL;                             // external script data, NULL if stored inline
     size_t scriptLen = 0;                                     // script length
+    size_t scriptCapacity = 0;                                // size of scriptArray
+    Arena * arena = NULL;                                     // where to allocate scriptArray, heap if NULL
+    uint8_t inlineArray[SCRIPT_INLINE_SIZE];                  // short scripts
 public:
     Script();                                                 // empty constructor
     Script(const uint8_t * buffer, size_t len);               // creates script from byte array
     Script(const char * address);                             // creates script from address
-    Script(const String address);                             // creates script from address
-    Script(const PublicKey pubkey, int type = P2PKH);         // creates one of standart scripts (P2PKH, P2WPKH)
-    Script(const Script &other);                              // copy
+    Script(const String &address);                            // creates script from address
+    Script(const PublicKey &pubkey, int type = P2PKH);        // creates one of standart scripts (P2PKH, P2WPKH)
+    Script(const Script &other);                              // copy, never uses an arena
+    Script(Script &&other);                                   // move, takes heap memory of the other script
     ~Script();                                                // destructor, clears memory
 
+    // allocates script data from the arena, falls back to the heap when it is full.
+    // The arena must outlive the script or the script must be empty when the arena is reset.
+    void useArena(Arena * a);
+
     // parses script from byte array or stream (<len><script>)
     size_t parse(const uint8_t * buffer, size_t len);         // parses raw array
     size_t parse(const uint8_t * buffer);                     // parses raw array
@@ -150,9 +217,9 @@ public:
 
     size_t push(uint8_t code);                                // pushes a single byte (op_code) to the end
     size_t push(const uint8_t * data, size_t len);            // pushes bytes from data object to the end
-    size_t push(const PublicKey pubkey);                      // adds <len><sec> to the script
-    size_t push(const Signature sig);//, uint8_t sigType = SIGHASH_ALL); // adds <len><der><sigType> to the script
-    size_t push(const Script sc);                             // adds <len><script> to the script (used for P2SH)
+    size_t push(const PublicKey &pubkey);                     // adds <len><sec> to the script
+    size_t push(const Signature &sig);//, uint8_t sigType = SIGHASH_ALL); // adds <len><der><sigType> to the script
+    size_t push(const Script &sc);                            // adds <len><script> to the script (used for P2SH)
 
     Script scriptPubkey() const;                              // returns scriptPubkey corresponding to this redeem script
 
@@ -160,13 +227,14 @@ public:
     // For example allows to do Serial.print(script)
     size_t printTo(Print& p) const;
 
-    Script &operator=(Script const &other);                   // assignment
+    Script &operator=(Script const &other);                   // assignment, reuses memory if it fits
+    Script &operator=(Script &&other);                        // move assignment
     operator String();
     // TODO: operator +, +=, etc
 
     // Bool conversion. Allows to use if(script) construction. Returns false if script is empty, true otherwise
     explicit operator bool() const{ return (scriptLen > 0); };
-    bool operator==(const Script& other) const{ return (scriptLen == other.scriptLen) && (memcmp(scriptArray, other.scriptArray, scriptLen) == 0); };
+    bool operator==(const Script& other) const{ return (scriptLen == other.scriptLen) && (memcmp(data(), other.data(), scriptLen) == 0); };
     bool operator!=(const Script& other) const{ return !operator==(other); };
 };
 
@@ -196,6 +264,9 @@ public:
     int nestedSegwitAddress(char * address, size_t len, bool testnet = false) const;
     String nestedSegwitAddress(bool testnet = false) const;
     bool verify(const Signature sig, const uint8_t hash[32]) const;
+    // Verifies n signatures at once, sharing modular inversions between them.
+    // Sets valid[i] for every entry if valid is not NULL, returns the number of valid signatures.
+    static size_t verifyBatch(const PublicKey * pubkeys, const Signature * sigs, const uint8_t (*hashes)[32], size_t n, bool * valid = NULL);
     bool isValid() const;
     Script script(int type = P2PKH) const;
 
@@ -309,9 +380,19 @@ public:
 
     HDPrivateKey child(uint32_t index) const;
     HDPrivateKey hardenedChild(uint32_t index) const;
+    // Derives a key from a path like "m/84'/0'/0'/0/5" ("h" also marks hardened indexes).
+    // With a cache intermediate keys are reused between calls.
+    // Returns an invalid key if the path can't be parsed.
+    HDPrivateKey derive(const char * path, HDPrivateKeyCache * cache = NULL) const;
     bool isValid() const;
     operator String(){ return xprv(); };
     explicit operator bool() const { return isValid(); };
+private:
+    // compressed sec of the public key and the first 4 bytes of its hash160,
+    // computed on first use and reused for every child and xpub
+    mutable uint8_t secCache[33] = { 0 };
+    mutable uint8_t idCache[4] = { 0 };
+    const uint8_t * cachedSec() const;
 };
 
 class HDPublicKey : public Printable{
@@ -344,9 +425,70 @@ public:
     size_t printTo(Print& p) const;
 
     HDPublicKey child(uint32_t index) const;
+    // Derives count children with indexes start, start+1, ... to out.
+    // Much faster than child() in a loop, as points of the children
+    // share modular inversions. Returns the number of valid children,
+    // a child is invalid in the extremely unlikely case BIP32 rejects it.
+    int children(uint32_t start, uint32_t count, HDPublicKey * out) const;
+    // Writes addresses of children start .. start+count-1 to out, null-terminated,
+    // one every stride bytes (36 is enough for base58 and 43 for bech32 addresses).
+    // addressType is P2PKH, P2SH_P2WPKH or P2WPKH, UNKNOWN_HD_TYPE uses type of the key.
+    // Doesn't allocate memory and hashes children in batches.
+    // Returns the number of addresses written, invalid children get empty strings.
+    int addresses(uint32_t start, uint32_t count, char * out, size_t stride, uint8_t addressType = UNKNOWN_HD_TYPE) const;
+    // Same as HDPrivateKey::derive(), hardened indexes give an invalid key
+    HDPublicKey derive(const char * path, HDPublicKeyCache * cache = NULL) const;
     bool isValid() const;
     operator String(){ return xpub(); };
     explicit operator bool() const { return isValid(); };
+private:
+    // same as in HDPrivateKey
+    mutable uint8_t secCache[33] = { 0 };
+    mutable uint8_t idCache[4] = { 0 };
+    const uint8_t * cachedSec() const;
+    // points and chain codes (if not NULL) of up to CHILDREN_BATCH children
+    int childPoints(uint32_t start, uint32_t count, uint8_t points[][64], uint8_t chainCodes[][32]) const;
+};
+
+/*
+    LRU caches of derived HD keys, keyed by the derivation path from the root key.
+    Pass one to derive() to reuse intermediate keys between calls,
+    then keys under the same account cost one derivation step.
+    A cache serves one root key at a time and starts over when used with another one
+    or with the same key on another network or with another type.
+    Classes are defined in HDWallet.cpp
+*/
+class HDPathCache{
+public:
+    HDPathCache(){ clear(); };
+    virtual ~HDPathCache(){};
+    virtual void clear();
+protected:
+    uint8_t root[67];                                   // sec, chain code, network and type of the root key
+    uint32_t paths[HD_CACHE_SIZE][HD_MAX_PATH_DEPTH];
+    uint8_t depths[HD_CACHE_SIZE];                      // 0 for empty slots
+    uint32_t lastUsed[HD_CACHE_SIZE];
+    uint32_t counter;
+
+    void bind(const uint8_t sec[33], const uint8_t chain_code[32], bool testnet, uint8_t type);
+    int find(const uint32_t * path, uint8_t depth);    // slot of the longest cached prefix or -1
+    int store(const uint32_t * path, uint8_t depth);   // slot for a new key
+};
+
+class HDPrivateKeyCache : public HDPathCache{
+    friend class HDPrivateKey;
+public:
+    ~HDPrivateKeyCache(){ clear(); };
+    // also erases cached private keys from memory
+    void clear();
+protected:
+    HDPrivateKey keys[HD_CACHE_SIZE];
+};
+
+class HDPublicKeyCache : public HDPathCache{
+    friend class HDPublicKey;
+protected:
+    HDPublicKey keys[HD_CACHE_SIZE];
 };
 
 /*
@@ -360,10 +502,12 @@ public:
     TransactionInput();
     TransactionInput(byte prev_id[32], uint32_t prev_index);
     TransactionInput(char prev_id_hex[], uint32_t prev_index);
-    TransactionInput(byte prev_id[32], uint32_t prev_index, Script script, uint32_t sequence_number = 0xffffffff);
-    TransactionInput(byte prev_id[32], uint32_t prev_index, uint32_t sequence_number, Script script);
+    TransactionInput(byte prev_id[32], uint32_t prev_index, const Script &script, uint32_t sequence_number = 0xffffffff);
+    TransactionInput(byte prev_id[32], uint32_t prev_index, uint32_t sequence_number, const Script &script);
     TransactionInput(TransactionInput const &other);
+    TransactionInput(TransactionInput &&other);
     TransactionInput &operator=(TransactionInput const &other);
+    TransactionInput &operator=(TransactionInput &&other);
 
     // TransactionInput(Stream & s){ parse(s); };
     // TransactionInput(byte raw[], size_t len){ parse(raw, len); };
@@ -385,25 +529,27 @@ public:
     size_t parse(Stream &s);
     size_t parse(byte raw[], size_t len);
     size_t length(); // length of the serialized bytes sequence
-    size_t length(Script script_pubkey); // length of the serialized bytes sequence with custom script
+    size_t length(const Script &script_pubkey); // length of the serialized bytes sequence with custom script
     size_t serialize(Stream &s); // serialize to Stream
-    size_t serialize(Stream &s, Script script_pubkey); // serialize to stream with custom script
+    size_t serialize(Stream &s, const Script &script_pubkey); // serialize to stream with custom script
     size_t serialize(uint8_t array[], size_t len); // serialize to array
-    size_t serialize(uint8_t array[], size_t len, Script script_pubkey); // use custom script for serialization
+    size_t serialize(uint8_t array[], size_t len, const Script &script_pubkey); // use custom script for serialization
     operator String();
 };
 
 class TransactionOutput{
 public:
     TransactionOutput();
-    TransactionOutput(uint64_t send_amount, Script outputScript);
+    TransactionOutput(uint64_t send_amount, const Script &outputScript);
     TransactionOutput(uint64_t send_amount, char address[]);
-    TransactionOutput(uint64_t send_amount, String address);
-    TransactionOutput(Script outputScript, uint64_t send_amount);
+    TransactionOutput(uint64_t send_amount, const String &address);
+    TransactionOutput(const Script &outputScript, uint64_t send_amount);
     TransactionOutput(char address[], uint64_t send_amount);
-    TransactionOutput(String address, uint64_t send_amount);
+    TransactionOutput(const String &address, uint64_t send_amount);
     TransactionOutput(TransactionOutput const &other);
+    TransactionOutput(TransactionOutput &&other);
     TransactionOutput &operator=(TransactionOutput const &other);
+    TransactionOutput &operator=(TransactionOutput &&other);
     // TransactionOutput(Stream & s){ parse(s); };
     // TransactionOutput(byte raw[], size_t len){ parse(raw, len); };
 
@@ -425,10 +571,16 @@ public:
     Transaction();
     Transaction(Stream &s){ parse(s); };
     Transaction(byte raw[], size_t len){ parse(raw, len); };
+    // inputs, outputs and their scripts are allocated from the arena,
+    // the transaction must be destroyed before the arena is reset.
+    // Copies of the transaction use the heap.
+    explicit Transaction(Arena &a){ arena = &a; };
     ~Transaction();
 
     Transaction(Transaction const &other);
+    Transaction(Transaction &&other);                   // takes inputs, outputs and the arena
     Transaction &operator=(Transaction const &other);
+    Transaction &operator=(Transaction &&other);
 
     uint32_t version = 1;
     TransactionInput * txIns = NULL;
@@ -439,8 +591,15 @@ public:
     size_t parse(byte raw[], size_t len);
     size_t inputsNumber = 0;
     size_t outputsNumber = 0;
-    uint8_t addInput(TransactionInput txIn);
-    uint8_t addOutput(TransactionOutput txOut);
+    uint8_t addInput(const TransactionInput &txIn);
+    uint8_t addInput(TransactionInput &&txIn);
+    uint8_t addOutput(const TransactionOutput &txOut);
+    uint8_t addOutput(TransactionOutput &&txOut);
+    // append an empty input or output and return it to be filled in place,
+    // NULL if out of memory. Pointer is valid until the next add or parse.
+    // New inputs have sequence 0xffffffff.
+    TransactionInput * emplaceInput();
+    TransactionOutput * emplaceOutput();
 
     size_t length(); // length of the serialized bytes sequence
     size_t serialize(Stream &s, bool segwit); // serialize to Stream
@@ -453,20 +612,183 @@ public:
     String id(); // returns hex string with id of the transaction
     bool isSegwit();
 
-    // populates hash with data for signing certain input with particular scriptPubkey
-    int sigHash(uint8_t inputIndex, Script scriptPubKey, uint8_t hash[32]);
+    // populates hash with data for signing certain input with particular scriptPubkey.
+    // Inputs before inputIndex and serialized outputs are cached between calls,
+    // so signing inputs in order doesn't rehash the same data again.
+    int sigHash(size_t inputIndex, const Script &scriptPubKey, uint8_t hash[32]);
 
     int hashPrevouts(uint8_t hash[32]);
     int hashSequence(uint8_t hash[32]);
     int hashOutputs(uint8_t hash[32]);
-    int sigHashSegwit(uint8_t inputIndex, Script scriptPubKey, uint8_t hash[32]);
+    int sigHashSegwit(size_t inputIndex, const Script &scriptPubKey, uint8_t hash[32]);
+
+    // computes hashPrevouts, hashSequence and hashOutputs once
+    // so sigHashSegwit doesn't recalculate them for every input,
+    // sigHash keeps serialized outputs and the inputs prefix as well.
+    // Without it every call hashes the whole transaction again.
+    // addInput, addOutput and parse drop the cache automatically,
+    // call clearSigHashCache() if you modify txIns or txOuts directly,
+    // version and locktime are not cached and can be changed at any time.
+    // signAll() and verifyInput() use the cache only during the call.
+    int precomputeSigHash();
+    void clearSigHashCache();
 
     // signes input and returns scriptSig with signature and public key
-    Signature signInput(uint8_t inputIndex, PrivateKey pk);
-    Signature signInput(uint8_t inputIndex, PrivateKey pk, Script redeemScript);
+    Signature signInput(size_t inputIndex, const PrivateKey &pk);
+    Signature signInput(size_t inputIndex, const PrivateKey &pk, const Script &redeemScript);
+    // signs every input, keys[i] signs input i with redeemScripts[i]
+    // or with its own P2PKH script if redeemScripts is NULL.
+    // Sighashes are computed first, then ECDSA signing is spread over
+    // threads workers (with BITCOIN_THREADS), results are the same as
+    // calling signInput() for every input in order.
+    // Returns number of signed inputs, 0 if out of memory.
+    size_t signAll(const PrivateKey * keys, const Script * redeemScripts = NULL, unsigned threads = 1);
+
+    // runs scriptSig, scriptPubKey and witness of the input through the script interpreter
+    // (P2PKH, P2SH, P2WPKH, P2WSH, multisig and any other script with legacy opcodes).
+    // Segwit inputs need txIns[inputIndex].amount to be set.
+    // Only SIGHASH_ALL signatures can be checked, others are treated as invalid,
+    // taproot outputs always fail. To reuse sighash data between inputs
+    // call precomputeSigHash() first and verify inputs in order.
+    // Valid signatures are remembered in the cache (if not NULL)
+    // and are not verified again when the same transaction is checked later.
+    // Defined in Interpreter.cpp
+    bool verifyInput(size_t inputIndex, const Script &scriptPubKey, SignatureCache * cache = NULL);
 
     // TODO: sort() - bip69, Lexicographical Indexing of Transaction Inputs and Outputs
     operator String();
+private:
+    Arena * arena = NULL;
+    void clearArrays(); // destroys inputs and outputs
+    // signInput() steps: data to sign and scriptSig / witness from the signature
+    void inputSigHash(size_t inputIndex, const PublicKey &pubkey, const Script &redeemScript, bool segwit, uint8_t hash[32]);
+    void setInputSignature(size_t inputIndex, const PublicKey &pubkey, const Script &redeemScript, bool segwit, const Signature &sig);
+    // verifyInput() with sighash caches enabled
+    bool runInputScripts(size_t inputIndex, const Script &scriptPubKey, SignatureCache * cache);
+
+    // cached BIP143 digests shared by all inputs
+    bool sigHashCached = false;
+    uint8_t cachedPrevouts[32];
+    uint8_t cachedSequence[32];
+    uint8_t cachedOutputs[32];
+
+    // legacy sighash state: hash of everything before input sigHashIndex
+    // (built for sigHashVersion) and serialized outputs
+    bool legacyCached = false;
+    size_t sigHashIndex = 0;
+    uint32_t sigHashVersion = 0;
+    DoubleSha sigHashPrefix;
+    uint8_t * sigHashSuffix = NULL;
+    size_t sigHashSuffixLen = 0;
+};
+
+/*
+    Bounded set of signatures that passed ECDSA verification,
+    keyed by sha256 of public key, sighash and signature, 32 bytes per entry.
+    Size it for the number of signatures checked between two validations
+    of the same transaction, when it is full old entries are overwritten.
+    Defined in Interpreter.cpp
+*/
+class SignatureCache{
+public:
+    SignatureCache(size_t entries = SIG_CACHE_SIZE);    // allocates entries on the heap
+    SignatureCache(uint8_t * buffer, size_t length);    // uses external memory, length / 32 entries
+    ~SignatureCache();
+    SignatureCache(const SignatureCache &other) = delete;
+    SignatureCache &operator=(const SignatureCache &other) = delete;
+
+    void clear();
+    size_t size() const{ return capacity; };            // number of entries, 0 if out of memory
+    bool contains(const uint8_t * pubkey, size_t pubkeyLen, const uint8_t hash[32], const uint8_t * sig, size_t sigLen);
+    void insert(const uint8_t * pubkey, size_t pubkeyLen, const uint8_t hash[32], const uint8_t * sig, size_t sigLen);
+protected:
+    uint8_t (*entries)[32] = NULL;                      // all-zero digest marks an empty slot
+    size_t capacity = 0;
+    bool ownsBuffer = false;
+    uint8_t victim = 0;                                 // next slot to evict from a full probe sequence
+
+    static void entry(const uint8_t * pubkey, size_t pubkeyLen, const uint8_t hash[32],
+                      const uint8_t * sig, size_t sigLen, uint8_t digest[32]);
+};
+
+/*
+ *  Read-only view of a serialized transaction.
+ *  Parsing checks the structure and remembers a few offsets,
+ *  fields are read from the caller's buffer on request
+ *  and scripts are returned as pointers into it, nothing is copied or allocated.
+ *  The buffer must outlive the view.
+ *  Inputs and outputs are located by walking from the last one asked for,
+ *  so reading them in order takes constant time per element
+ *  and going back walks from the first one again.
+ *  The position is kept in the view, don't share one between threads.
+ */
+
+struct ByteSpan{
+    const uint8_t * data;
+    size_t len;
+};
+
+struct TransactionInputView{
+    const uint8_t * hash;       // 32 bytes of previous transaction hash, as serialized
+    uint32_t outputIndex;
+    ByteSpan scriptSig;
+    uint32_t sequence;
+    ByteSpan witness;           // serialized witness: number of items, then items; empty if none
+};
+
+struct TransactionOutputView{
+    uint64_t amount;
+    ByteSpan scriptPubKey;
+};
+
+class TransactionView{
+public:
+    TransactionView(){};
+    TransactionView(const uint8_t * raw, size_t len){ parse(raw, len); };
+
+    // returns the number of bytes used by the transaction or 0 if it is invalid
+    size_t parse(const uint8_t * raw, size_t len);
+    bool isValid() const{ return raw != NULL; };
+    bool isSegwit() const{ return segwit; };
+
+    uint32_t version = 0;
+    uint32_t locktime = 0;
+    size_t inputsNumber = 0;
+    size_t outputsNumber = 0;
+
+    TransactionInputView input(size_t index) const;
+    TransactionOutputView output(size_t index) const;
+    // element of the input witness stack, empty span if there is no such element
+    ByteSpan witnessItem(size_t inputIndex, size_t itemIndex) const;
+    size_t length() const{ return rawLen; };  // length of the serialized transaction
+
+    // computed on first call
+    int hash(uint8_t hash[32]) const;          // hash without witness data
+    int id(uint8_t id_arr[32]) const;          // reverse of hash
+    String id() const;
+    int witnessHash(uint8_t hash[32]) const;   // hash of the full serialization (wtxid)
+    int witnessId(uint8_t id_arr[32]) const;
+private:
+    const uint8_t * raw = NULL;
+    size_t rawLen = 0;
+    bool segwit = false;
+    size_t inputsOffset = 0;     // first input
+    size_t outputsOffset = 0;    // first output
+    size_t witnessOffset = 0;    // witness of the first input
+    size_t locktimeOffset = 0;
+
+    // index and offset of the last input, output and input witness located
+    mutable size_t lastInput = 0;
+    mutable size_t lastInputOffset = 0;
+    mutable size_t lastOutput = 0;
+    mutable size_t lastOutputOffset = 0;
+    mutable size_t lastWitness = 0;
+    mutable size_t lastWitnessOffset = 0;
+
+    mutable bool hashed = false;
+    mutable bool witnessHashed = false;
+    mutable uint8_t txHash[32];
+    mutable uint8_t wtxHash[32];
 };
 
 #endif /* __BITCOIN_H__BDDNDVJ300 */
\ No newline at end of file
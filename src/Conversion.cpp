@@ -6,23 +6,227 @@
 // consts static PROGMEM?
 char BASE58_CHARS[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
-size_t toHex(const uint8_t * array, size_t arraySize, char * output, size_t outputSize){
-    if(outputSize < 2*arraySize){
-        return 0;
+// inputs up to this size (keys, addresses) are encoded without heap allocations
+#define BASE58_STACK_BUFFER 82
+
+/*
+ *  Base58 numbers are converted a limb at a time instead of a byte at a time.
+ *  Encoding keeps the number in limbs of BASE58_LIMB_DIGITS base58 digits
+ *  (58^5 in 32 bits) and feeds the input a limb of bytes at once,
+ *  decoding keeps it in 32-bit limbs and feeds BASE58_LIMB_DIGITS characters at once.
+ *  8-bit boards use 16-bit limbs so intermediate products fit in 32 bits.
+ */
+#if defined(__AVR__)
+typedef uint16_t base58_limb_t;
+typedef uint32_t base58_wide_t;
+#define BASE58_LIMB_BYTES   2
+#define BASE58_LIMB_DIGITS  2
+#define BASE58_LIMB_RADIX   3364UL       // 58^2
+#else
+typedef uint32_t base58_limb_t;
+typedef uint64_t base58_wide_t;
+#define BASE58_LIMB_BYTES   4
+#define BASE58_LIMB_DIGITS  5
+#define BASE58_LIMB_RADIX   656356768UL  // 58^5
+#endif
+
+// limbs of the encoder for a number of bytes, every limb holds at least 5.8 * BASE58_LIMB_DIGITS bits
+#define BASE58_ENCODE_LIMBS(bytes) ((bytes) * 40 / (BASE58_LIMB_DIGITS * 29) + 2)
+// limbs of the decoder for a number of characters, every character is less than 0.75 bytes
+#define BASE58_DECODE_LIMBS(chars) (((chars) * 3 / 4 + 1) / BASE58_LIMB_BYTES + 2)
+// payload + checksum of the extended keys fit on the stack in both directions
+#define BASE58_STACK_LIMBS BASE58_ENCODE_LIMBS(BASE58_STACK_BUFFER + 4)
+
+#if defined(__GNUC__)
+#define BASE58_INLINE inline __attribute__((always_inline))
+#else
+#define BASE58_INLINE inline
+#endif
+
+static const char HEX_CHARS[] = "0123456789abcdef";
+
+// bytes encoded at once by toHex(array, arraySize, Print)
+#define HEX_PRINT_CHUNK 32
+
+/*
+ *  x86 kernels convert 16 (SSE2) or 32 (AVX2) bytes per iteration,
+ *  AVX2 is picked at runtime. Everything else and the tails are scalar.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define HEX_X86 1
+#include <immintrin.h>
+#else
+#define HEX_X86 0
+#endif
+
+#if HEX_X86
+
+static int hexAVX2Supported(){
+    static volatile int supported = -1;
+    if(supported < 0){
+        __builtin_cpu_init();
+        supported = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return supported;
+}
+
+// nibbles to lowercase ascii: n + '0', plus 'a' - '0' - 10 for n > 9
+static inline __m128i hexCharsSSE2(__m128i n){
+    __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(n, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+    return _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')), letters);
+}
+
+static size_t toHexSSE2(const uint8_t * array, size_t arraySize, char * output){
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for(; i + 16 <= arraySize; i += 16){
+        __m128i v = _mm_loadu_si128((const __m128i *)(array + i));
+        __m128i hi = hexCharsSSE2(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i lo = hexCharsSSE2(_mm_and_si128(v, mask));
+        _mm_storeu_si128((__m128i *)(output + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)(output + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t toHexAVX2(const uint8_t * array, size_t arraySize, char * output){
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i letter = _mm256_set1_epi8('a' - '0' - 10);
+    size_t i = 0;
+    for(; i + 32 <= arraySize; i += 32){
+        __m256i v = _mm256_loadu_si256((const __m256i *)(array + i));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask);
+        __m256i lo = _mm256_and_si256(v, mask);
+        hi = _mm256_add_epi8(_mm256_add_epi8(hi, zero), _mm256_and_si256(_mm256_cmpgt_epi8(hi, nine), letter));
+        lo = _mm256_add_epi8(_mm256_add_epi8(lo, zero), _mm256_and_si256(_mm256_cmpgt_epi8(lo, nine), letter));
+        // unpack works within 128-bit lanes, so halves are reordered afterwards
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i *)(output + 2 * i), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i *)(output + 2 * i + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    return i;
+}
+
+// values of 16 hex characters, valid gets 0xFF for every hex character
+static inline __m128i hexValuesSSE2(__m128i c, __m128i * valid){
+    // unsigned x < n is signed (x ^ 0x80) < (n ^ 0x80)
+    const __m128i bias = _mm_set1_epi8((char)0x80);
+    __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i a = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i isDigit = _mm_cmplt_epi8(_mm_xor_si128(d, bias), _mm_set1_epi8((char)(10 ^ 0x80)));
+    __m128i isLetter = _mm_cmplt_epi8(_mm_xor_si128(a, bias), _mm_set1_epi8((char)(6 ^ 0x80)));
+    *valid = _mm_or_si128(isDigit, isLetter);
+    return _mm_or_si128(_mm_and_si128(isDigit, d),
+                        _mm_and_si128(isLetter, _mm_add_epi8(a, _mm_set1_epi8(10))));
+}
+
+// stops before the first block with a non-hex character
+static size_t fromHexSSE2(const char * hex, size_t len, uint8_t * array){
+    const __m128i low = _mm_set1_epi16(0x00FF);
+    size_t i = 0;
+    for(; i + 16 <= len; i += 16){
+        __m128i valid1, valid2;
+        __m128i v1 = hexValuesSSE2(_mm_loadu_si128((const __m128i *)(hex + 2 * i)), &valid1);
+        __m128i v2 = hexValuesSSE2(_mm_loadu_si128((const __m128i *)(hex + 2 * i + 16)), &valid2);
+        if(_mm_movemask_epi8(_mm_and_si128(valid1, valid2)) != 0xFFFF){
+            break;
+        }
+        // every 16-bit word has the high nibble in the low byte
+        v1 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v1, low), 4), _mm_srli_epi16(v1, 8));
+        v2 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v2, low), 4), _mm_srli_epi16(v2, 8));
+        _mm_storeu_si128((__m128i *)(array + i), _mm_packus_epi16(v1, v2));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t fromHexAVX2(const char * hex, size_t len, uint8_t * array){
+    const __m256i bias = _mm256_set1_epi8((char)0x80);
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i lower = _mm256_set1_epi8(0x20);
+    const __m256i a_ = _mm256_set1_epi8('a');
+    const __m256i ten = _mm256_set1_epi8((char)(10 ^ 0x80));
+    const __m256i six = _mm256_set1_epi8((char)(6 ^ 0x80));
+    const __m256i low = _mm256_set1_epi16(0x00FF);
+    size_t i = 0;
+    for(; i + 32 <= len; i += 32){
+        __m256i v[2];
+        __m256i valid = _mm256_set1_epi8((char)0xFF);
+        for(int k = 0; k < 2; k++){
+            __m256i c = _mm256_loadu_si256((const __m256i *)(hex + 2 * i + 32 * k));
+            __m256i d = _mm256_sub_epi8(c, zero);
+            __m256i a = _mm256_sub_epi8(_mm256_or_si256(c, lower), a_);
+            __m256i isDigit = _mm256_cmpgt_epi8(ten, _mm256_xor_si256(d, bias));
+            __m256i isLetter = _mm256_cmpgt_epi8(six, _mm256_xor_si256(a, bias));
+            valid = _mm256_and_si256(valid, _mm256_or_si256(isDigit, isLetter));
+            v[k] = _mm256_or_si256(_mm256_and_si256(isDigit, d),
+                                   _mm256_and_si256(isLetter, _mm256_add_epi8(a, _mm256_set1_epi8(10))));
+            v[k] = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(v[k], low), 4), _mm256_srli_epi16(v[k], 8));
+        }
+        if(_mm256_movemask_epi8(valid) != -1){
+            break;
+        }
+        // pack works within 128-bit lanes, 64-bit quarters are reordered afterwards
+        __m256i packed = _mm256_packus_epi16(v[0], v[1]);
+        _mm256_storeu_si256((__m256i *)(array + i), _mm256_permute4x64_epi64(packed, 0xD8));
     }
-    memset(output, 0, outputSize);
+    return i;
+}
 
-    for(int i=0; i < arraySize; i++){
-        output[2*i] = (array[i] >> 4) + '0';
-        if(output[2*i] > '9'){
-            output[2*i] += 'a'-'9'-1;
-        }
+#endif /* HEX_X86 */
+
+// encodes as many bytes as the SIMD kernels can, returns number of encoded bytes
+static size_t toHexBlocks(const uint8_t * array, size_t arraySize, char * output){
+#if HEX_X86
+    if(hexAVX2Supported()){
+        size_t i = toHexAVX2(array, arraySize, output);
+        return i + toHexSSE2(array + i, arraySize - i, output + 2 * i);
+    }
+    return toHexSSE2(array, arraySize, output);
+#else
+    return 0;
+#endif
+}
 
-        output[2*i+1] = (array[i] & 0x0F) + '0';
-        if(output[2*i+1] > '9'){
-            output[2*i+1] += 'a'-'9'-1;
+// encodes arraySize bytes, output should fit 2 * arraySize characters
+static void toHexRaw(const uint8_t * array, size_t arraySize, char * output){
+    for(size_t i = toHexBlocks(array, arraySize, output); i < arraySize; i++){
+        output[2*i] = HEX_CHARS[array[i] >> 4];
+        output[2*i+1] = HEX_CHARS[array[i] & 0x0F];
+    }
+}
+
+// decodes up to len bytes, stops at the first non-hex character
+// and returns number of decoded bytes
+static size_t fromHexRaw(const char * hex, size_t len, uint8_t * array){
+    size_t i = 0;
+#if HEX_X86
+    if(hexAVX2Supported()){
+        i = fromHexAVX2(hex, len, array);
+    }
+    i += fromHexSSE2(hex + 2 * i, len - i, array + i);
+#endif
+    for(; i < len; i++){
+        uint8_t v1 = hexToVal(hex[2*i]);
+        uint8_t v2 = hexToVal(hex[2*i+1]);
+        if((v1 > 0x0F) || (v2 > 0x0F)){ // if invalid char stop parsing
+            break;
         }
+        array[i] = (v1<<4) | v2;
+    }
+    return i;
+}
+
+size_t toHex(const uint8_t * array, size_t arraySize, char * output, size_t outputSize){
+    if(outputSize < 2*arraySize){
+        return 0;
     }
+    toHexRaw(array, arraySize, output);
+    memset(output + 2*arraySize, 0, outputSize - 2*arraySize);
     return 2*arraySize;
 }
 
@@ -30,6 +234,9 @@ String toHex(const uint8_t * array, size_t arraySize){
     char * output;
     size_t outputSize = arraySize * 2 + 1;
     output = (char *) malloc(outputSize);
+    if(output == NULL){
+        return String();
+    }
 
     toHex(array, arraySize, output, outputSize);
     
@@ -57,9 +264,16 @@ size_t toHex(uint8_t v, Print &s){
 }
 
 size_t toHex(const uint8_t * array, size_t arraySize, Print &s){
+    // whole chunks go to the Print at once instead of a character at a time
+    char buf[2*HEX_PRINT_CHUNK];
     size_t l = 0;
-    for(int i=0; i<arraySize; i++){
-        l += toHex(array[i], s);
+    for(size_t i = 0; i < arraySize; i += HEX_PRINT_CHUNK){
+        size_t len = arraySize - i;
+        if(len > HEX_PRINT_CHUNK){
+            len = HEX_PRINT_CHUNK;
+        }
+        toHexRaw(array + i, len, buf);
+        l += s.write((const uint8_t *)buf, 2*len);
     }
     return l;
 }
@@ -91,15 +305,11 @@ size_t fromHex(const char * hex, size_t hexLen, uint8_t * array, size_t arraySiz
         }
     }
     hexLen -= offset;
-    for(int i=0; i<hexLen/2; i++){
-        byte v1 = hexToVal(hex[offset+2*i]);
-        byte v2 = hexToVal(hex[offset+2*i+1]);
-        if((v1 > 0x0F) || (v2 > 0x0F)){ // if invalid char stop parsing
-            return i;
-        }
-        array[i] = (v1<<4) | v2;
+    size_t len = hexLen/2;
+    if(len > arraySize){ // stop when array is full
+        len = arraySize;
     }
-    return hexLen/2;
+    return fromHexRaw(hex+offset, len, array);
 }
 
 size_t fromHex(const char * hex, uint8_t * array, size_t arraySize){
@@ -107,6 +317,19 @@ size_t fromHex(const char * hex, uint8_t * array, size_t arraySize){
     return fromHex(hex, len, array, arraySize);
 }
 
+size_t fromHexStrict(const char * hex, size_t hexLen, uint8_t * array, size_t arraySize){
+    memset(array, 0, arraySize);
+    if((hexLen % 2 != 0) || (hexLen/2 > arraySize)){
+        return 0;
+    }
+    size_t l = fromHexRaw(hex, hexLen/2, array);
+    if(l != hexLen/2){
+        memset(array, 0, l);
+        return 0;
+    }
+    return l;
+}
+
 
 size_t toBase58Length(const uint8_t * array, size_t arraySize){
     // Counting leading zeroes
@@ -128,97 +351,144 @@ size_t toBase58Length(const uint8_t * array, size_t arraySize){
     return size+zeroCount;
 }
 
-size_t toBase58(const uint8_t * array, size_t arraySize, char * output, size_t outputSize){
+// multiplies the number in limbs by 256^bytes and adds value
+static BASE58_INLINE void base58EncodeLimb(base58_limb_t * limbs, size_t * used, uint8_t bytes, base58_limb_t value){
+    base58_wide_t carry = value;
+    for(size_t j = 0; j < *used; j++){
+        base58_wide_t t = ((base58_wide_t)limbs[j] << (8 * bytes)) + carry;
+        limbs[j] = t % BASE58_LIMB_RADIX;
+        carry = t / BASE58_LIMB_RADIX;
+    }
+    while(carry > 0){
+        limbs[(*used)++] = carry % BASE58_LIMB_RADIX;
+        carry /= BASE58_LIMB_RADIX;
+    }
+}
+
+// big-endian bytes to a limb
+static BASE58_INLINE base58_limb_t base58ReadLimb(const uint8_t * array, uint8_t bytes){
+    base58_limb_t value = 0;
+    for(uint8_t i = 0; i < bytes; i++){
+        value = (value << 8) | array[i];
+    }
+    return value;
+}
+
+/*
+ *  Encodes array followed by suffix (checksum, can be empty).
+ *  Inlined with constant sizes for addresses and extended keys,
+ *  so the compiler can unroll feeding of the input.
+ */
+static BASE58_INLINE size_t base58Encode(const uint8_t * array, size_t arraySize,
+                                         const uint8_t * suffix, size_t suffixSize,
+                                         char * output, size_t outputSize){
     // Counting leading zeroes
     size_t zeroCount = 0;
     while(zeroCount < arraySize && !array[zeroCount]){
         zeroCount++;
     }
-
-    // TODO: refactor with real sizes
-    // size estimation. 56/41 ≈ log(58)/log(256)
-    size_t size = (arraySize - zeroCount) * 183 / 134 + 1;
-    // size_t size = (arraySize - zeroCount) * 137 / 100 + 1;
+    if(zeroCount == arraySize){
+        while(zeroCount < arraySize + suffixSize && !suffix[zeroCount - arraySize]){
+            zeroCount++;
+        }
+    }
+    size_t totalSize = arraySize + suffixSize;
+    // same estimation as toBase58Length(), callers allocate output with it
+    size_t size = (totalSize - zeroCount) * 183 / 134 + 1;
     if(outputSize < size+zeroCount){
         return 0;
     }
 
-    memset(output, 0, outputSize);
-
-    // array copy for manipulations
-    size_t bufferSize = arraySize - zeroCount;
-    uint8_t * buffer;
-    buffer = (uint8_t *)calloc(bufferSize, sizeof(uint8_t));
-    for(size_t i = zeroCount; i < arraySize; i++){
-        buffer[i - zeroCount] = array[i];
-    }
-
-    for(size_t j = 0; j < size; j++){
-        uint16_t reminder = 0;
-        uint16_t temp = 0;
-        for(size_t i = 0; i < bufferSize; i++){      
-            temp = (reminder * 256 + buffer[i]);
-            reminder = temp % 58;
-            buffer[i] = temp/58;
+    size_t limbsSize = BASE58_ENCODE_LIMBS(totalSize - zeroCount);
+    base58_limb_t stackLimbs[BASE58_STACK_LIMBS];
+    base58_limb_t * limbs = stackLimbs;
+    if(limbsSize > BASE58_STACK_LIMBS){
+        limbs = (base58_limb_t *)calloc(limbsSize, sizeof(base58_limb_t));
+        if(limbs == NULL){
+            return 0;
         }
-        output[size+zeroCount-j-1] = BASE58_CHARS[reminder];
     }
-    free(buffer);
-    for (int i = 0; i < zeroCount; i++){
-        output[i] = BASE58_CHARS[0];
+    size_t used = 0;
+
+    // leading zeroes don't change the number, the rest goes a limb at a time
+    // starting with a partial one so the checksum is aligned
+    size_t start = (zeroCount < arraySize) ? zeroCount : arraySize;
+    uint8_t head = (arraySize - start) % BASE58_LIMB_BYTES;
+    if(head > 0){
+        base58EncodeLimb(limbs, &used, head, base58ReadLimb(array + start, head));
+    }
+    for(size_t i = start + head; i < arraySize; i += BASE58_LIMB_BYTES){
+        base58EncodeLimb(limbs, &used, BASE58_LIMB_BYTES, base58ReadLimb(array + i, BASE58_LIMB_BYTES));
     }
-    if(outputSize > size+zeroCount){
-        output[size+zeroCount] = '\0';
+    for(size_t i = 0; i + BASE58_LIMB_BYTES <= suffixSize; i += BASE58_LIMB_BYTES){
+        base58EncodeLimb(limbs, &used, BASE58_LIMB_BYTES, base58ReadLimb(suffix + i, BASE58_LIMB_BYTES));
     }
 
-    // removing leading zeroes
-    // TODO: refactor
-    int shift = 0;
-    for(int i=zeroCount; i < size+zeroCount; i++){
-        if(output[i]==BASE58_CHARS[0]){
-            shift++;
-        }else{
-            break;
+    // digits in the most significant limb don't have leading zeroes
+    size_t digits = 0;
+    if(used > 0){
+        digits = (used - 1) * BASE58_LIMB_DIGITS;
+        for(base58_limb_t v = limbs[used - 1]; v > 0; v /= 58){
+            digits++;
         }
     }
-    if(shift>0){
-        for(int i=zeroCount+shift; i < size+zeroCount; i++){
-            output[i-shift] = output[i];
-            output[i] = 0;
+    size_t l = zeroCount + digits;
+    size_t pos = l;
+    for(size_t j = 0; j < used; j++){
+        base58_limb_t v = limbs[j];
+        for(uint8_t k = 0; k < BASE58_LIMB_DIGITS && pos > zeroCount; k++){
+            output[--pos] = BASE58_CHARS[v % 58];
+            v /= 58;
         }
     }
-    size_t l = size+zeroCount-shift;
-    memset(output + l, 0, outputSize-l);
+    memset(output, BASE58_CHARS[0], zeroCount);
+    memset(output + l, 0, outputSize - l);
+
+    memset(limbs, 0, used * sizeof(base58_limb_t)); // secret should not stay in RAM
+    if(limbs != stackLimbs){
+        free(limbs);
+    }
     return l;
 }
+
+size_t toBase58(const uint8_t * array, size_t arraySize, char * output, size_t outputSize){
+    return base58Encode(array, arraySize, NULL, 0, output, outputSize);
+}
 String toBase58(const uint8_t * array, size_t arraySize){
     size_t len = toBase58Length(array, arraySize) + 1; // +1 for null terminator
     char * buf = (char *)malloc(len);
+    if(buf == NULL){
+        return String();
+    }
     toBase58(array, arraySize, buf, len);
     String result(buf);
+    memset(buf, 0, len);
     free(buf);
     return result;
 }
 
 size_t toBase58Check(const uint8_t * array, size_t arraySize, char * output, size_t outputSize){
-    uint8_t * arr;
-    arr = (byte *) malloc(arraySize+4);
-    memcpy(arr, array, arraySize);
-
+    // checksum is encoded right after the array, nothing is copied
     uint8_t hash[32];
-    doubleSha(arr, arraySize, hash);
-    memcpy(arr+arraySize, hash, 4);
-
-    size_t l = toBase58(arr, arraySize+4, output, outputSize);
-    memset(arr, 0, arraySize+4); // secret should not stay in RAM
-    free(arr);
-    return l;
+    doubleSha(array, arraySize, hash);
+    switch(arraySize){
+        case 21: // addresses
+            return base58Encode(array, 21, hash, 4, output, outputSize);
+        case 78: // extended keys
+            return base58Encode(array, 78, hash, 4, output, outputSize);
+        default:
+            return base58Encode(array, arraySize, hash, 4, output, outputSize);
+    }
 }
 String toBase58Check(const uint8_t * array, size_t arraySize){
     size_t len = toBase58Length(array, arraySize) + 5; // +4 checksum +1 for null terminator
     char * buf = (char *)malloc(len);
+    if(buf == NULL){
+        return String();
+    }
     toBase58Check(array, arraySize, buf, len);
     String result(buf);
+    memset(buf, 0, len);
     free(buf);
     return result;
 }
@@ -230,100 +500,144 @@ size_t fromBase58Length(const char * array, size_t arraySize){
     return size;
 }
 
-size_t fromBase58(const char * encoded, size_t encodedSize, uint8_t * output, size_t outputSize){
+// value of the base58 character, 0xFF if it's not in the alphabet
+static uint8_t base58Value(char c){
+    if(c >= '1' && c <= '9'){
+        return c - '1';
+    }
+    if(c >= 'A' && c <= 'H'){
+        return c - 'A' + 9;
+    }
+    if(c >= 'J' && c <= 'N'){
+        return c - 'J' + 17;
+    }
+    if(c >= 'P' && c <= 'Z'){
+        return c - 'P' + 22;
+    }
+    if(c >= 'a' && c <= 'k'){
+        return c - 'a' + 33;
+    }
+    if(c >= 'm' && c <= 'z'){
+        return c - 'm' + 44;
+    }
+    return 0xFF;
+}
+
+/*
+ *  Decodes base58 up to the first character outside of the alphabet.
+ *  The last suffixSize bytes of the result go to suffix (checksum),
+ *  the rest to output. Returns number of bytes in output,
+ *  0 if the result doesn't fit or is shorter than suffixSize.
+ */
+static size_t base58Decode(const char * encoded, size_t encodedSize,
+                           uint8_t * output, size_t outputSize,
+                           uint8_t * suffix, size_t suffixSize){
     memset(output, 0, outputSize);
 
     size_t l;
     // looking for the end of char array
     for(l=0; l<encodedSize; l++){
-        char * pch = strchr(BASE58_CHARS, encoded[l]);
-        if(pch==NULL){ // char not in the alphabet
+        if(base58Value(encoded[l]) == 0xFF){ // char not in the alphabet
             break;
         }
     }
     encodedSize = l;
-    size_t size = fromBase58Length(encoded, encodedSize);
-    uint8_t * tmp;
-    tmp = (uint8_t *) calloc(size, sizeof(uint8_t));
 
-    uint8_t zeroCount = 0;
-    for(int i = 0; i<encodedSize; i++){
-        if(encoded[i] == BASE58_CHARS[0]){
-            zeroCount++;
-        }else{
-            break;
-        }
+    size_t zeroCount = 0;
+    while(zeroCount < encodedSize && encoded[zeroCount] == BASE58_CHARS[0]){
+        zeroCount++;
     }
 
-    uint16_t val = 0;
-    for(size_t i = 0; i < encodedSize; i++){
-        char * pch = strchr(BASE58_CHARS, encoded[i]);
-        if(pch!=NULL){
-            val = pch - BASE58_CHARS;
-            for(size_t j = 0; j < size; j++){
-                uint16_t cur = tmp[size-j-1]*58;
-                cur += val;
-                val = cur/256;
-                tmp[size-j-1] = cur%256;
-            }
-        }else{
+    size_t limbsSize = BASE58_DECODE_LIMBS(encodedSize - zeroCount);
+    base58_limb_t stackLimbs[BASE58_STACK_LIMBS];
+    base58_limb_t * limbs = stackLimbs;
+    if(limbsSize > BASE58_STACK_LIMBS){
+        limbs = (base58_limb_t *)calloc(limbsSize, sizeof(base58_limb_t));
+        if(limbs == NULL){
             return 0;
         }
     }
-    // shifting array
-    uint8_t shift = 0;
-    for(int i = zeroCount; i < size; i++){
-        if(tmp[i] == 0){
-            shift++;
-        }else{
-            break;
+    size_t used = 0;
+
+    // number = number * 58^digits + value, BASE58_LIMB_DIGITS characters at a time
+    size_t i = zeroCount;
+    uint8_t head = (encodedSize - zeroCount) % BASE58_LIMB_DIGITS;
+    uint8_t digits = (head > 0) ? head : BASE58_LIMB_DIGITS;
+    while(i < encodedSize){
+        base58_wide_t mul = 1;
+        base58_wide_t carry = 0;
+        for(uint8_t k = 0; k < digits; k++){
+            mul *= 58;
+            carry = carry * 58 + base58Value(encoded[i++]);
+        }
+        for(size_t j = 0; j < used; j++){
+            base58_wide_t t = (base58_wide_t)limbs[j] * mul + carry;
+            limbs[j] = (base58_limb_t)t;
+            carry = t >> (8 * BASE58_LIMB_BYTES);
+        }
+        if(carry > 0){
+            limbs[used++] = (base58_limb_t)carry;
+        }
+        digits = BASE58_LIMB_DIGITS;
+    }
+
+    // leading '1' are zero bytes, then the number without leading zeroes
+    size_t valueSize = used * BASE58_LIMB_BYTES;
+    while(valueSize > 0 && ((limbs[(valueSize - 1) / BASE58_LIMB_BYTES] >> (8 * ((valueSize - 1) % BASE58_LIMB_BYTES))) & 0xFF) == 0){
+        valueSize--;
+    }
+    size_t total = zeroCount + valueSize;
+    size_t len = 0;
+    if(total >= suffixSize && total - suffixSize <= outputSize){
+        len = total - suffixSize;
+        // byte k from the end of the result
+        for(size_t k = 0; k < valueSize; k++){
+            uint8_t v = limbs[k / BASE58_LIMB_BYTES] >> (8 * (k % BASE58_LIMB_BYTES));
+            if(k < suffixSize){
+                suffix[suffixSize - 1 - k] = v;
+            }else{
+                output[total - 1 - k] = v;
+            }
+        }
+        for(size_t k = valueSize; k < suffixSize; k++){
+            suffix[suffixSize - 1 - k] = 0;
         }
     }
-    if(size-shift > outputSize){
-        return 0;
+
+    memset(limbs, 0, used * sizeof(base58_limb_t)); // secret should not stay in RAM
+    if(limbs != stackLimbs){
+        free(limbs);
     }
-    memcpy(output, tmp+shift, size-shift);
-    free(tmp);
-    return size-shift;
+    return len;
 }
 
-size_t fromBase58(String encoded, uint8_t * output, size_t outputSize){
-    size_t len = encoded.length()+1; // +1 for null terminator
-    char * arr = (char *)malloc(len);
-    encoded.toCharArray(arr, len);
-    size_t l = fromBase58(arr, len, output, outputSize);
-    free(arr);
-    return l;
+size_t fromBase58(const char * encoded, size_t encodedSize, uint8_t * output, size_t outputSize){
+    return base58Decode(encoded, encodedSize, output, outputSize, NULL, 0);
+}
+
+size_t fromBase58(const String &encoded, uint8_t * output, size_t outputSize){
+    return fromBase58(encoded.c_str(), encoded.length(), output, outputSize);
 }
 
 size_t fromBase58Check(const char * encoded, size_t encodedSize, uint8_t * output, size_t outputSize){
-    uint8_t * arr;
-    arr = (byte *) malloc(outputSize+4);
-    size_t l = fromBase58(encoded, encodedSize, arr, outputSize+4);
-    if(l<4){
+    // payload is decoded straight into output, checksum separately
+    uint8_t checksum[4];
+    size_t l = base58Decode(encoded, encodedSize, output, outputSize, checksum, sizeof(checksum));
+    if(l == 0){
         return 0;
     }
 
     uint8_t hash[32];
-    doubleSha(arr, l-4, hash);
-    if(memcmp(arr+l-4, hash, 4)!=0){
+    doubleSha(output, l, hash);
+    if(memcmp(checksum, hash, 4)!=0){
+        memset(output, 0, l);
         return 0;
     }
-
-    memcpy(output, arr, l-4);
-
-    memset(arr, 0, outputSize+4); // secret should not stay in RAM
-    free(arr);
-    return l-4;
+    return l;
 }
 
-size_t fromBase58Check(String encoded, uint8_t * output, size_t outputSize){
-    size_t len = encoded.length()+1; // +1 for null terminator
-    char * arr = (char *)malloc(len);
-    encoded.toCharArray(arr, len);
-    size_t l = fromBase58Check(arr, len, output, outputSize);
-    free(arr);
-    return l;
+size_t fromBase58Check(const String &encoded, uint8_t * output, size_t outputSize){
+    return fromBase58Check(encoded.c_str(), encoded.length(), output, outputSize);
 }
 
 /* Integer conversion */
@@ -438,15 +752,28 @@ size_t writeVarInt(uint64_t num, Stream &s){
 /* Stream conversion */
 ByteStream::ByteStream(){}
 ByteStream::ByteStream(uint8_t * buffer, size_t length){
-    len = length;
-    buf = (uint8_t *) calloc( length, sizeof(uint8_t));
-    memcpy(buf, buffer, length);
+    if(reserve(length)){
+        memcpy(buf, buffer, length);
+        len = length;
+    }
 }
 ByteStream::~ByteStream(void){
-    if(len > 0){
+    if(buf != NULL){
         free(buf);
     }
 }
+bool ByteStream::reserve(size_t length){
+    if(length <= capacity){
+        return true;
+    }
+    uint8_t * arr = ( uint8_t * )realloc( buf, length );
+    if(arr == NULL){
+        return false;
+    }
+    buf = arr;
+    capacity = length;
+    return true;
+}
 int ByteStream::available(){
     if(cursor >= len){
         return 0;
@@ -483,15 +810,89 @@ size_t ByteStream::readBytes(uint8_t * buffer, size_t length){
     return length;
 }
 size_t ByteStream::write(uint8_t b){
-    buf = ( uint8_t * )realloc( buf, len + 1 );
-    buf[len] = b;
-    len ++;
-    return 1;
+    return write(&b, 1);
 }
 size_t ByteStream::write(uint8_t * arr, size_t length){
-    buf = ( uint8_t * )realloc( buf, len + length );
+    if(len + length > capacity){
+        // geometric growth, so writing byte by byte is amortized O(1)
+        size_t cap = 2 * capacity;
+        if(cap < 16){
+            cap = 16;
+        }
+        if(cap < len + length){
+            cap = len + length;
+        }
+        if(!reserve(cap)){
+            return 0;
+        }
+    }
     memcpy(buf + len, arr, length);
     len += length;
     return length;
 }
 
+HashStream::HashStream(HashAlgorithm &hashAlgorithm){
+    algo = &hashAlgorithm;
+}
+size_t HashStream::write(uint8_t b){
+    return algo->write(b);
+}
+size_t HashStream::write(const uint8_t * arr, size_t length){
+    return algo->write(arr, length);
+}
+
+/* Memory management */
+Arena::Arena(uint8_t * buffer, size_t length){
+    buf = buffer;
+    capacity = length;
+}
+Arena::Arena(size_t length){
+    buf = (uint8_t *) calloc( length, sizeof(uint8_t));
+    if(buf != NULL){
+        capacity = length;
+        ownsBuffer = true;
+    }
+}
+Arena::~Arena(void){
+    if(ownsBuffer){
+        free(buf);
+    }
+}
+void * Arena::alloc(size_t length){
+    // external buffers can start anywhere, so the address is aligned, not the offset
+    size_t pad = (size_t)(-(uintptr_t)(buf + cursor)) & ((size_t)ARENA_ALIGN - 1);
+    size_t start = cursor + pad;
+    if(length == 0 || start > capacity || length > capacity - start){
+        return NULL;
+    }
+    cursor = start + length;
+    last = buf + start;
+    memset(last, 0, length);
+    return last;
+}
+void * Arena::grow(void * ptr, size_t oldLength, size_t newLength){
+    uint8_t * p = (uint8_t *)ptr;
+    if(p == NULL){
+        return alloc(newLength);
+    }
+    if(p == last && newLength <= capacity - (size_t)(p - buf)){
+        if(newLength > oldLength){
+            memset(p + oldLength, 0, newLength - oldLength);
+        }
+        cursor = (p - buf) + newLength;
+        return p;
+    }
+    uint8_t * n = (uint8_t *)alloc(newLength);
+    if(n != NULL){
+        memcpy(n, p, (oldLength < newLength) ? oldLength : newLength);
+    }
+    return n;
+}
+bool Arena::owns(const void * ptr) const{
+    const uint8_t * p = (const uint8_t *)ptr;
+    return (p != NULL) && (p >= buf) && (p < buf + capacity);
+}
+void Arena::reset(){
+    cursor = 0;
+    last = NULL;
+}
@@ -20,16 +20,20 @@ String toBase58Check(const uint8_t * array, size_t arraySize);
 size_t fromBase58Length(const char * array, size_t arraySize);
 size_t fromBase58(const char * encoded, size_t encodedSize, uint8_t * output, size_t outputSize);
 size_t fromBase58Check(const char * encoded, size_t encodedSize, uint8_t * output, size_t outputSize);
-size_t fromBase58(String encoded, uint8_t * output, size_t outputSize);
-size_t fromBase58Check(String encoded, uint8_t * output, size_t outputSize);
+size_t fromBase58(const String &encoded, uint8_t * output, size_t outputSize);
+size_t fromBase58Check(const String &encoded, uint8_t * output, size_t outputSize);
 
 size_t toHex(const uint8_t * array, size_t arraySize, char * output, size_t outputSize);
 String toHex(const uint8_t * array, size_t arraySize);
 size_t toHex(uint8_t v, Print &s); // printing single hex value to Print
 size_t toHex(const uint8_t * array, size_t arraySize, Print &s); // printing array in hex Print
 
+// lenient: skips non-hex characters in the beginning, stops at the first
+// invalid character or when array is full, returns number of decoded bytes
 size_t fromHex(const char * hex, uint8_t * array, size_t arraySize);
 size_t fromHex(const char * hex, size_t hexLen, uint8_t * array, size_t arraySize);
+// strict: all hexLen characters should be hex and fit in array, returns 0 otherwise
+size_t fromHexStrict(const char * hex, size_t hexLen, uint8_t * array, size_t arraySize);
 
 uint8_t hexToVal(char c);
 
@@ -55,11 +59,16 @@ size_t writeVarInt(uint64_t num, Stream &s);
 class ByteStream : public Stream{
     size_t len = 0;
     size_t cursor = 0;
+    size_t capacity = 0;
     uint8_t * buf = NULL;
 public:
     ByteStream();
     ByteStream(uint8_t * buffer, size_t length);
     ~ByteStream();
+    // preallocates memory for length bytes in total, e.g. from Transaction::length()
+    bool reserve(size_t length);
+    // unread bytes, available() of them. Valid until the next write
+    const uint8_t * data() const{ return buf + cursor; };
     int available();
     int read();
     int peek();
@@ -69,6 +78,58 @@ public:
     size_t write(uint8_t * arr, size_t length);
 };
 
+class HashAlgorithm;
+
+/* HashStream class
+   Feeds everything written to it into a hash function.
+   Allows to hash serialized objects without storing them in memory.
+ */
+class HashStream : public Stream{
+    HashAlgorithm * algo;
+public:
+    HashStream(HashAlgorithm &hashAlgorithm);
+    int available(){ return 0; };
+    int read(){ return -1; };
+    int peek(){ return -1; };
+    void flush(){};
+    size_t write(uint8_t b);
+    size_t write(const uint8_t * arr, size_t length);
+};
+
+/* Memory management */
+
+#ifndef ARENA_ALIGN
+#define ARENA_ALIGN 8
+#endif
+
+/* Arena class
+   Bump allocator over a single block of memory.
+   Allocation is a pointer increment and nothing is freed individually,
+   reset() releases everything at once. Used by Transaction and Script
+   to avoid hundreds of small heap allocations per transaction.
+   alloc() returns NULL when the block is full, callers fall back to the heap.
+ */
+class Arena{
+    uint8_t * buf = NULL;
+    size_t capacity = 0;
+    size_t cursor = 0;
+    uint8_t * last = NULL; // most recent allocation, can grow in place
+    bool ownsBuffer = false;
+public:
+    Arena(uint8_t * buffer, size_t length); // uses external memory
+    Arena(size_t length);                   // allocates the block on the heap
+    ~Arena();
+    Arena(const Arena &other) = delete;
+    Arena &operator=(const Arena &other) = delete;
+
+    void * alloc(size_t length);            // zeroed memory or NULL if there is no space
+    // like realloc for memory from this arena, grows in place if ptr is the last allocation
+    void * grow(void * ptr, size_t oldLength, size_t newLength);
+    bool owns(const void * ptr) const;
+    void reset();                           // frees all allocations, objects using them must be gone
+    size_t used() const{ return cursor; };
+    size_t size() const{ return capacity; };
+};
 
 
 #endif // BASEX_H_6LV8N942E3
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "utility/micro-ecc/uECC.h"
 #include "utility/trezor/sha2.h"
 #include "utility/segwit_addr.h"
+#include "utility/trezor/memzero.h"
 
 // ---------------------------------------------------------------- HDPrivateKey class
 
@@ -42,6 +43,21 @@ uint8_t UPRV_PREFIX[4] = { 0x04, 0x4a, 0x4e, 0x28 };
 uint8_t VPUB_PREFIX[4] = { 0x04, 0x5f, 0x1c, 0xf6 };
 uint8_t VPRV_PREFIX[4] = { 0x04, 0x5f, 0x18, 0xbc };
 
+// Updates compressed sec and key identifier (first 4 bytes of hash160)
+// if they were not computed yet or the point has changed since.
+// HD keys always use compressed sec.
+static const uint8_t * updateSecCache(const uint8_t point[64], uint8_t sec[33], uint8_t id[4]){
+    uint8_t prefix = 0x02 + (point[63] & 1);
+    if(sec[0] != prefix || memcmp(sec+1, point, 32) != 0){
+        sec[0] = prefix;
+        memcpy(sec+1, point, 32);
+        uint8_t hash[20];
+        hash160(sec, 33, hash);
+        memcpy(id, hash, 4);
+    }
+    return sec;
+}
+
 // TODO: make friends with PrivateKey to get secret or inherit from it
 HDPrivateKey::HDPrivateKey(void){
     privateKey.compressed = true;
@@ -109,6 +125,9 @@ HDPrivateKey::HDPrivateKey(const char * xprvArr){
     memcpy(secret, arr+46, 32);
     privateKey = PrivateKey(secret, true, testnet);
 }
+const uint8_t * HDPrivateKey::cachedSec() const{
+    return updateSecCache(privateKey.publicKey().point, secCache, idCache);
+}
 HDPrivateKey::~HDPrivateKey(void) {
     // erase chain code from memory
     memset(chainCode, 0, 32);
@@ -124,34 +143,31 @@ int HDPrivateKey::fromSeed(const uint8_t * seed, size_t seedSize, bool use_testn
     // sha512Hmac((byte *)key, strlen(key), seed, 64, raw);
     privateKey = PrivateKey(raw, true, use_testnet);
     memcpy(chainCode, raw+32, 32);
+    memset(raw, 0, sizeof(raw));
+    return privateKey.isValid();
 }
 // int HDPrivateKey::fromSeed(const uint8_t seed[64], bool use_testnet){
 //     fromSeed(seed, 64);
 // }
 int HDPrivateKey::fromMnemonic(const char * mnemonic, size_t mnemonicSize, const char * password, size_t passwordSize, bool use_testnet){
     uint8_t seed[64] = { 0 };
-    uint8_t ind[4] = { 0, 0, 0, 1 };
-    char salt[] = "mnemonic";
-    uint8_t u[64] = { 0 };
+    const char prefix[] = "mnemonic";
+    size_t prefixSize = strlen(prefix);
 
-    // first round
-    SHA512 sha;
-    sha.beginHMAC((uint8_t *)mnemonic, mnemonicSize);
-    sha.write((uint8_t *)salt, strlen(salt));
-    sha.write((uint8_t *)password, passwordSize);
-    sha.write(ind, sizeof(ind));
-    sha.endHMAC(u);
-    memcpy(seed, u, 64);
-    // other rounds
-    for(int i=1; i<PBKDF2_ROUNDS; i++){
-        sha.beginHMAC((uint8_t *)mnemonic, mnemonicSize);
-        sha.write(u, sizeof(u));
-        sha.endHMAC(u);
-        for(int j=0; j<sizeof(seed); j++){
-            seed[j] = seed[j] ^ u[j];
-        }
-    }
-    fromSeed(seed, sizeof(seed), use_testnet);
+    // salt is "mnemonic" + password
+    uint8_t * salt = (uint8_t *)calloc(prefixSize + passwordSize, sizeof(uint8_t));
+    if(salt == NULL){
+        return 0;
+    }
+    memcpy(salt, prefix, prefixSize);
+    memcpy(salt + prefixSize, password, passwordSize);
+    pbkdf2_hmac_sha512((const uint8_t *)mnemonic, mnemonicSize, salt, prefixSize + passwordSize,
+                       PBKDF2_ROUNDS, seed, sizeof(seed));
+    memset(salt, 0, prefixSize + passwordSize);
+    free(salt);
+    int res = fromSeed(seed, sizeof(seed), use_testnet);
+    memset(seed, 0, sizeof(seed));
+    return res;
 }
 bool HDPrivateKey::isValid() const{
     return privateKey.isValid();
@@ -241,10 +257,8 @@ int HDPrivateKey::xpub(char * arr, size_t len) const{
     }
     memcpy(hex+13, chainCode, 32);
 
-    uint8_t sec[65] = { 0 };
-    int secLen = privateKey.publicKey().sec(sec, sizeof(sec));
-    memcpy(hex+45, sec, secLen);
-    return toBase58Check(hex, 45+secLen, arr, len);
+    memcpy(hex+45, cachedSec(), 33);
+    return toBase58Check(hex, 45+33, arr, len);
 }
 String HDPrivateKey::xpub() const{
     char arr[112] = { 0 };
@@ -255,25 +269,22 @@ String HDPrivateKey::xpub() const{
 HDPrivateKey HDPrivateKey::child(uint32_t index) const{
     HDPrivateKey child;
 
-    uint8_t sec[65] = { 0 };
-    int l = privateKey.publicKey().sec(sec, sizeof(sec));
-    uint8_t hash[20] = { 0 };
-    hash160(sec, l, hash);
-    memcpy(child.fingerprint, hash, 4);
+    const uint8_t * sec = cachedSec();
+    memcpy(child.fingerprint, idCache, 4);
     child.childNumber = index;
     child.depth = depth+1;
     child.type = type;
 
-    uint8_t data[69];
-    memcpy(data, sec, l);
+    uint8_t data[37];
+    memcpy(data, sec, 33);
     for(uint8_t i=0; i<4; i++){
-        data[l+3-i] = ((index >> (i*8)) & 0xFF);
+        data[36-i] = ((index >> (i*8)) & 0xFF);
     }
 
     uint8_t raw[64];
     SHA512 sha;
     sha.beginHMAC(chainCode, sizeof(chainCode));
-    sha.write(data, l+4);
+    sha.write(data, sizeof(data));
     sha.endHMAC(raw);
 
     memcpy(child.chainCode, raw+32, 32);
@@ -331,11 +342,8 @@ HDPrivateKey HDPrivateKey::hardenedChild(uint32_t index) const{
     // TODO: refactor, the same used in two functions
     HDPrivateKey child;
 
-    uint8_t sec[65] = { 0 };
-    int l = privateKey.publicKey().sec(sec, sizeof(sec));
-    uint8_t hash[20] = { 0 };
-    hash160(sec, l, hash);
-    memcpy(child.fingerprint, hash, 4);
+    cachedSec();
+    memcpy(child.fingerprint, idCache, 4);
     child.depth = depth+1;
     // bip44, bip49, bip84
     child.type = type;
@@ -418,6 +426,70 @@ HDPrivateKey HDPrivateKey::hardenedChild(uint32_t index) const{
     return child;
 }
 
+// parses "m/44'/0'/0'/0/1" to indexes, returns path depth or -1 on error
+static int parsePath(const char * path, uint32_t indexes[HD_MAX_PATH_DEPTH]){
+    int depth = 0;
+    if(*path == 'm' || *path == 'M'){
+        path++;
+    }
+    while(*path == '/'){
+        path++;
+        if(*path < '0' || *path > '9' || depth >= HD_MAX_PATH_DEPTH){
+            return -1;
+        }
+        uint32_t index = 0;
+        while(*path >= '0' && *path <= '9'){
+            uint32_t d = *path - '0';
+            // checked before multiplying, so the index can't wrap around
+            if(index > (HARDENED_INDEX - 1 - d) / 10){
+                return -1;
+            }
+            index = index * 10 + d;
+            path++;
+        }
+        if(*path == '\'' || *path == 'h' || *path == 'H'){
+            index += HARDENED_INDEX;
+            path++;
+        }
+        indexes[depth] = index;
+        depth++;
+    }
+    if(*path != 0){
+        return -1;
+    }
+    return depth;
+}
+
+HDPrivateKey HDPrivateKey::derive(const char * path, HDPrivateKeyCache * cache) const{
+    uint32_t indexes[HD_MAX_PATH_DEPTH];
+    int depth = parsePath(path, indexes);
+    if(depth < 0){
+        return HDPrivateKey();
+    }
+    HDPrivateKey key = *this;
+    int start = 0;
+    if(cache != NULL){
+        cache->bind(cachedSec(), chainCode, privateKey.testnet, type);
+        int slot = cache->find(indexes, depth);
+        if(slot >= 0){
+            key = cache->keys[slot];
+            start = cache->depths[slot];
+        }
+    }
+    for(int i=start; i<depth; i++){
+        if(indexes[i] >= HARDENED_INDEX){
+            key = key.hardenedChild(indexes[i] - HARDENED_INDEX);
+        }else{
+            key = key.child(indexes[i]);
+        }
+        // leaves are rarely asked twice, intermediate keys are
+        if(cache != NULL && i+1 < depth){
+            cache->keys[cache->store(indexes, i+1)] = key;
+        }
+    }
+    return key;
+}
+
 // ---------------------------------------------------------------- HDPublicKey class
 
 HDPublicKey::HDPublicKey(void){
@@ -486,6 +558,9 @@ HDPublicKey::HDPublicKey(const char * xpubArr){
     memcpy(sec_arr, arr+45, 33);
     publicKey.fromSec(sec_arr);
 }
+const uint8_t * HDPublicKey::cachedSec() const{
+    return updateSecCache(publicKey.point, secCache, idCache);
+}
 HDPublicKey::~HDPublicKey(void) {
     // erase chain code from memory
     memset(chainCode, 0, 32);
@@ -525,10 +600,8 @@ int HDPublicKey::xpub(char * arr, size_t len) const{
     }
     memcpy(hex+13, chainCode, 32);
 
-    uint8_t sec[65] = { 0 };
-    int secLen = publicKey.sec(sec, sizeof(sec));
-    memcpy(hex+45, sec, secLen);
-    return toBase58Check(hex, 45+secLen, arr, len);
+    memcpy(hex+45, cachedSec(), 33);
+    return toBase58Check(hex, 45+33, arr, len);
 }
 String HDPublicKey::xpub() const{
     char arr[114] = { 0 };
@@ -553,25 +626,22 @@ size_t HDPublicKey::printTo(Print &p) const{
 HDPublicKey HDPublicKey::child(uint32_t index) const{
     HDPublicKey child;
 
-    uint8_t sec[65] = { 0 };
-    int l = publicKey.sec(sec, sizeof(sec));
-    uint8_t hash[20] = { 0 };
-    hash160(sec, l, hash);
-    memcpy(child.fingerprint, hash, 4);
+    const uint8_t * sec = cachedSec();
+    memcpy(child.fingerprint, idCache, 4);
     child.childNumber = index;
     child.depth = depth+1;
     child.type = type;
 
-    uint8_t data[69];
-    memcpy(data, sec, l);
+    uint8_t data[37];
+    memcpy(data, sec, 33);
     for(uint8_t i=0; i<4; i++){
-        data[l+3-i] = ((index >> (i*8)) & 0xFF);
+        data[36-i] = ((index >> (i*8)) & 0xFF);
     }
 
     uint8_t raw[64];
     SHA512 sha;
     sha.beginHMAC(chainCode, sizeof(chainCode));
-    sha.write(data, l+4);
+    sha.write(data, sizeof(data));
     sha.endHMAC(raw);
 
     memcpy(child.chainCode, raw+32, 32);
@@ -588,4 +658,222 @@ HDPublicKey HDPublicKey::child(uint32_t index) const{
     child.publicKey = PublicKey(point, true);
     child.testnet = testnet;
     return child;
-}
\ No newline at end of file
+}
+HDPublicKey HDPublicKey::derive(const char * path, HDPublicKeyCache * cache) const{
+    uint32_t indexes[HD_MAX_PATH_DEPTH];
+    int depth = parsePath(path, indexes);
+    if(depth < 0){
+        return HDPublicKey();
+    }
+    for(int i=0; i<depth; i++){
+        if(indexes[i] >= HARDENED_INDEX){
+            return HDPublicKey();
+        }
+    }
+    HDPublicKey key = *this;
+    int start = 0;
+    if(cache != NULL){
+        cache->bind(cachedSec(), chainCode, testnet, type);
+        int slot = cache->find(indexes, depth);
+        if(slot >= 0){
+            key = cache->keys[slot];
+            start = cache->depths[slot];
+        }
+    }
+    for(int i=start; i<depth; i++){
+        key = key.child(indexes[i]);
+        if(cache != NULL && i+1 < depth){
+            cache->keys[cache->store(indexes, i+1)] = key;
+        }
+    }
+    return key;
+}
+
+int HDPublicKey::childPoints(uint32_t start, uint32_t count, uint8_t points[][64], uint8_t chainCodes[][32]) const{
+    const struct uECC_Curve_t * curve = uECC_secp256k1();
+    uint8_t tweaks[CHILDREN_BATCH][32];
+    uint8_t raw[64];
+    uint8_t data[37];
+
+    // HMAC key and the parent part of the message are the same for all children
+    SHA512 sha;
+    sha.prepareHMAC(chainCode, sizeof(chainCode));
+    memcpy(data, cachedSec(), 33);
+    for(uint32_t j=0; j<count; j++){
+        uint32_t index = start+j;
+        for(uint8_t k=0; k<4; k++){
+            data[36-k] = ((index >> (k*8)) & 0xFF);
+        }
+        sha.beginHMAC();
+        sha.write(data, sizeof(data));
+        sha.endHMAC(raw);
+        memcpy(tweaks[j], raw, 32);
+        if(chainCodes != NULL){
+            memcpy(chainCodes[j], raw+32, 32);
+        }
+    }
+    memset(raw, 0, sizeof(raw));
+    return uECC_tweak_add_batch(publicKey.point, tweaks[0], count, points[0], curve);
+}
+int HDPublicKey::children(uint32_t start, uint32_t count, HDPublicKey * out) const{
+    uint8_t points[CHILDREN_BATCH][64];
+    uint8_t chainCodes[CHILDREN_BATCH][32];
+    int valid = 0;
+
+    cachedSec();
+    for(uint32_t i=0; i<count; i+=CHILDREN_BATCH){
+        uint32_t n = count - i;
+        if(n > CHILDREN_BATCH){
+            n = CHILDREN_BATCH;
+        }
+        valid += childPoints(start+i, n, points, chainCodes);
+        for(uint32_t j=0; j<n; j++){
+            HDPublicKey &child = out[i+j];
+            child.publicKey = PublicKey(points[j], true);
+            memcpy(child.chainCode, chainCodes[j], 32);
+            memcpy(child.fingerprint, idCache, 4);
+            child.childNumber = start+i+j;
+            child.depth = depth+1;
+            child.type = type;
+            child.testnet = testnet;
+        }
+    }
+    return valid;
+}
+int HDPublicKey::addresses(uint32_t start, uint32_t count, char * out, size_t stride, uint8_t addressType) const{
+    uint8_t points[CHILDREN_BATCH][64];
+    uint8_t secs[CHILDREN_BATCH][33];
+    uint8_t hashes[CHILDREN_BATCH][32];
+    uint8_t scripts[CHILDREN_BATCH][22];
+    uint8_t payloads[CHILDREN_BATCH][21];
+    uint8_t addr[25];
+    int valid = 0;
+
+    if(addressType == UNKNOWN_HD_TYPE){
+        addressType = type;
+    }
+    for(uint32_t i=0; i<count; i+=CHILDREN_BATCH){
+        uint32_t n = count - i;
+        if(n > CHILDREN_BATCH){
+            n = CHILDREN_BATCH;
+        }
+        childPoints(start+i, n, points, NULL);
+
+        // hash160 of the compressed keys, sha256 of all keys at once
+        for(uint32_t j=0; j<n; j++){
+            secs[j][0] = 0x02 + (points[j][63] & 1);
+            memcpy(secs[j]+1, points[j], 32);
+        }
+        sha256Batch(secs[0], 33, n, hashes[0]);
+        for(uint32_t j=0; j<n; j++){
+            scripts[j][0] = 0x00;
+            scripts[j][1] = 0x14;
+            rmd160(hashes[j], 32, scripts[j]+2);
+        }
+        if(addressType == P2SH_P2WPKH){
+            // hash160 of the 0014<hash> redeem script
+            sha256Batch(scripts[0], 22, n, hashes[0]);
+            for(uint32_t j=0; j<n; j++){
+                rmd160(hashes[j], 32, payloads[j]+1);
+                payloads[j][0] = testnet ? BITCOIN_TESTNET_P2SH : BITCOIN_MAINNET_P2SH;
+            }
+        }else if(addressType != P2WPKH){
+            for(uint32_t j=0; j<n; j++){
+                memcpy(payloads[j]+1, scripts[j]+2, 20);
+                payloads[j][0] = testnet ? BITCOIN_TESTNET_P2PKH : BITCOIN_MAINNET_P2PKH;
+            }
+        }
+        if(addressType != P2WPKH){
+            // base58check checksums of all payloads at once
+            doubleShaBatch(payloads[0], 21, n, hashes[0]);
+        }
+
+        for(uint32_t j=0; j<n; j++){
+            char * address = out + (i+j) * stride;
+            memset(address, 0, stride);
+            // invalid children have zero points
+            if(points[j][63] == 0 && memcmp(points[j], points[j]+1, 63) == 0){
+                continue;
+            }
+            if(addressType == P2WPKH){
+                if(stride < 43){
+                    continue;
+                }
+                segwit_addr_encode(address, testnet ? "tb" : "bc", 0, scripts[j]+2, 20);
+            }else{
+                memcpy(addr, payloads[j], 21);
+                memcpy(addr+21, hashes[j], 4);
+                // no room for the null terminator is a failure as well
+                size_t len = toBase58(addr, sizeof(addr), address, stride);
+                if(len == 0 || len >= stride){
+                    memset(address, 0, stride);
+                    continue;
+                }
+            }
+            valid++;
+        }
+    }
+    return valid;
+}
+
+// ---------------------------------------------------------------- HDPathCache class
+
+void HDPathCache::clear(){
+    memset(root, 0, sizeof(root));
+    memset(depths, 0, sizeof(depths));
+    memset(lastUsed, 0, sizeof(lastUsed));
+    counter = 0;
+}
+void HDPathCache::bind(const uint8_t sec[33], const uint8_t chain_code[32], bool testnet, uint8_t type){
+    // network and type are inherited by derived keys, so they are part of the root
+    if(memcmp(root, sec, 33) == 0 && memcmp(root+33, chain_code, 32) == 0
+       && root[65] == testnet && root[66] == type){
+        return;
+    }
+    clear();
+    memcpy(root, sec, 33);
+    memcpy(root+33, chain_code, 32);
+    root[65] = testnet;
+    root[66] = type;
+}
+void HDPrivateKeyCache::clear(){
+    HDPathCache::clear();
+    for(int i=0; i<HD_CACHE_SIZE; i++){
+        memzero(keys[i].privateKey.secret, 32);
+        memzero(keys[i].chainCode, 32);
+    }
+}
+int HDPathCache::find(const uint32_t * path, uint8_t depth){
+    int best = -1;
+    for(int i=0; i<HD_CACHE_SIZE; i++){
+        if(depths[i] == 0 || depths[i] > depth){
+            continue;
+        }
+        if(best >= 0 && depths[i] <= depths[best]){
+            continue;
+        }
+        if(memcmp(paths[i], path, depths[i]*sizeof(uint32_t)) == 0){
+            best = i;
+        }
+    }
+    if(best >= 0){
+        lastUsed[best] = ++counter;
+    }
+    return best;
+}
+int HDPathCache::store(const uint32_t * path, uint8_t depth){
+    int slot = 0;
+    for(int i=0; i<HD_CACHE_SIZE; i++){
+        if(depths[i] == depth && memcmp(paths[i], path, depth*sizeof(uint32_t)) == 0){
+            slot = i;
+            break;
+        }
+        if(lastUsed[i] < lastUsed[slot]){
+            slot = i;
+        }
+    }
+    memcpy(paths[slot], path, depth*sizeof(uint32_t));
+    depths[slot] = depth;
+    lastUsed[slot] = ++counter;
+    return slot;
+}
@@ -1,6 +1,7 @@
 #include "Hash.h"
 #include "utility/trezor/sha2.h"
 #include "utility/trezor/ripemd160.h"
+#include "utility/trezor/memzero.h"
 
 // generic funtcions for single line hash
 static size_t hashData(HashAlgorithm * algo, const uint8_t * data, size_t len, uint8_t * hash){
@@ -127,6 +128,10 @@ size_t Hash160::end(uint8_t hash[20]){
 /******************** sha256( sha256( m ) ) ******************/
 
 int doubleSha(const uint8_t * data, size_t len, uint8_t hash[32]){
+    if(len == 64){ // two concatenated hashes, as in Merkle trees
+        sha256d_64(data, hash);
+        return 32;
+    }
     DoubleSha sha;
     return hashData(&sha, data, len, hash);
 }
@@ -147,6 +152,17 @@ size_t DoubleSha::end(uint8_t hash[32]){
     return 32;
 }
 
+/********************** Batch SHA-256 ************************/
+
+int sha256Batch(const uint8_t * data, size_t len, size_t count, uint8_t * hashes){
+    sha256_many(data, len, count, hashes);
+    return count * 32;
+}
+int doubleShaBatch(const uint8_t * data, size_t len, size_t count, uint8_t * hashes){
+    sha256d_many(data, len, count, hashes);
+    return count * 32;
+}
+
 /************************** SHA-512 **************************/
 
 int sha512(const uint8_t * data, size_t len, uint8_t hash[64]){
@@ -166,9 +182,27 @@ int sha512(const String data, uint8_t hash[64]){
 void SHA512::begin(){
     sha512_Init(&ctx.ctx);
 };
+SHA512::~SHA512(){
+    memzero(ipad_digest, sizeof(ipad_digest));
+    memzero(opad_digest, sizeof(opad_digest));
+}
 void SHA512::beginHMAC(const uint8_t * key, size_t keySize){
+    prepared = false;
     hmac_sha512_Init(&ctx, key, keySize);
 }
+void SHA512::prepareHMAC(const uint8_t * key, size_t keySize){
+    hmac_sha512_prepare(key, keySize, opad_digest, ipad_digest);
+}
+// continues a hash from the state after one block (a prepared HMAC pad)
+static void sha512_resume(SHA512_CTX * ctx, const uint64_t state[8]){
+    memcpy(ctx->state, state, 8 * sizeof(uint64_t));
+    ctx->bitcount[0] = SHA512_BLOCK_LENGTH * 8;
+    ctx->bitcount[1] = 0;
+}
+void SHA512::beginHMAC(){
+    prepared = true;
+    sha512_resume(&ctx.ctx, ipad_digest);
+}
 size_t SHA512::write(const uint8_t * data, size_t len){
     sha512_Update(&ctx.ctx, data, len);
     return len;
@@ -183,7 +217,14 @@ size_t SHA512::end(uint8_t hash[64]){
     return 64;
 }
 size_t SHA512::endHMAC(uint8_t hmac[64]){
-    hmac_sha512_Final(&ctx, hmac);
+    if(!prepared){
+        hmac_sha512_Final(&ctx, hmac);
+        return 64;
+    }
+    sha512_Final(&ctx.ctx, hmac);
+    sha512_resume(&ctx.ctx, opad_digest);
+    sha512_Update(&ctx.ctx, hmac, SHA512_DIGEST_LENGTH);
+    sha512_Final(&ctx.ctx, hmac);
     return 64;
 }
 
@@ -191,3 +232,136 @@ int sha512Hmac(const uint8_t * key, size_t keyLen, const uint8_t * data, size_t
     hmac_sha512(key, keyLen, data, dataLen, hash);
     return 64;
 }
+
+/************************** PBKDF2 ***************************/
+
+// U_1 = HMAC(password, salt || INT(block)) from the prepared pad states.
+// u gets it as host-order words followed by the padding of a 64-byte
+// message after the pad block, so every next round is two transforms.
+static void pbkdf2_first(const uint64_t ipad[8], const uint64_t opad[8],
+                         const uint8_t * salt, size_t saltLen, uint32_t block,
+                         uint64_t u[16]){
+    SHA512_CTX ctx;
+    uint8_t digest[64];
+    uint8_t ind[4] = { (uint8_t)(block >> 24), (uint8_t)(block >> 16), (uint8_t)(block >> 8), (uint8_t)block };
+
+    sha512_resume(&ctx, ipad);
+    sha512_Update(&ctx, salt, saltLen);
+    sha512_Update(&ctx, ind, sizeof(ind));
+    sha512_Final(&ctx, digest);
+    sha512_resume(&ctx, opad);
+    sha512_Update(&ctx, digest, sizeof(digest));
+    sha512_Final(&ctx, digest);
+    for(int i=0; i<8; i++){
+        u[i] = 0;
+        for(int j=0; j<8; j++){
+            u[i] = (u[i] << 8) | digest[8*i+j];
+        }
+    }
+    u[8] = 0x8000000000000000ULL;
+    for(int i=9; i<15; i++){
+        u[i] = 0;
+    }
+    u[15] = (SHA512_BLOCK_LENGTH + SHA512_DIGEST_LENGTH) * 8;
+    memzero(digest, sizeof(digest));
+}
+
+// writes up to 64 bytes of the block result t, big endian
+static void pbkdf2_store(const uint64_t t[8], uint8_t * out, size_t len){
+    for(size_t i=0; i<len; i++){
+        out[i] = (uint8_t)(t[i/8] >> (56 - 8*(i%8)));
+    }
+}
+
+int pbkdf2_hmac_sha512(const uint8_t * password, size_t passwordLen,
+                       const uint8_t * salt, size_t saltLen,
+                       uint32_t iterations, uint8_t * out, size_t outLen){
+    uint64_t ipad[8], opad[8], u[16], s[8], t[8];
+
+    hmac_sha512_prepare(password, passwordLen, opad, ipad);
+    for(size_t offset=0; offset<outLen; offset+=SHA512_DIGEST_LENGTH){
+        pbkdf2_first(ipad, opad, salt, saltLen, offset/SHA512_DIGEST_LENGTH+1, u);
+        memcpy(t, u, sizeof(t));
+        for(uint32_t i=1; i<iterations; i++){
+            sha512_Transform(ipad, u, s);
+            memcpy(u, s, sizeof(s));
+            sha512_Transform(opad, u, s);
+            memcpy(u, s, sizeof(s));
+            for(int j=0; j<8; j++){
+                t[j] ^= u[j];
+            }
+        }
+        size_t len = outLen - offset;
+        if(len > SHA512_DIGEST_LENGTH){
+            len = SHA512_DIGEST_LENGTH;
+        }
+        pbkdf2_store(t, out+offset, len);
+    }
+    memzero(ipad, sizeof(ipad));
+    memzero(opad, sizeof(opad));
+    memzero(u, sizeof(u));
+    memzero(s, sizeof(s));
+    memzero(t, sizeof(t));
+    return outLen;
+}
+
+int pbkdf2_hmac_sha512_batch(const uint8_t * const passwords[], const size_t passwordLens[],
+                             const uint8_t * const salts[], const size_t saltLens[],
+                             size_t count, uint32_t iterations, uint8_t * out, size_t outLen){
+    uint64_t ipad[SHA512_LANES][8], opad[SHA512_LANES][8];
+    uint64_t u[SHA512_LANES][16], s[SHA512_LANES][8], t[SHA512_LANES][8];
+
+    // spare lanes hash whatever is left in u, it only has to be initialized
+    memset(u, 0, sizeof(u));
+
+    for(size_t k=0; k<count; k+=SHA512_LANES){
+        size_t lanes = count - k;
+        if(lanes > SHA512_LANES){
+            lanes = SHA512_LANES;
+        }
+        for(size_t l=0; l<lanes; l++){
+            hmac_sha512_prepare(passwords[k+l], passwordLens[k+l], opad[l], ipad[l]);
+        }
+        // spare lanes of the last group repeat the first key, their results are dropped
+        for(size_t l=1; l<SHA512_LANES; l++){
+            if(l >= lanes){
+                memcpy(ipad[l], ipad[0], sizeof(ipad[l]));
+                memcpy(opad[l], opad[0], sizeof(opad[l]));
+            }
+        }
+        for(size_t offset=0; offset<outLen; offset+=SHA512_DIGEST_LENGTH){
+            for(size_t l=0; l<lanes; l++){
+                pbkdf2_first(ipad[l], opad[l], salts[k+l], saltLens[k+l], offset/SHA512_DIGEST_LENGTH+1, u[l]);
+                memcpy(t[l], u[l], sizeof(t[l]));
+            }
+            for(uint32_t i=1; i<iterations; i++){
+                sha512_Transform_x4(ipad, u, s);
+                for(int l=0; l<SHA512_LANES; l++){
+                    memcpy(u[l], s[l], sizeof(s[l]));
+                }
+                sha512_Transform_x4(opad, u, s);
+                for(int l=0; l<SHA512_LANES; l++){
+                    memcpy(u[l], s[l], sizeof(s[l]));
+                }
+                for(size_t l=0; l<lanes; l++){
+                    for(int j=0; j<8; j++){
+                        t[l][j] ^= u[l][j];
+                    }
+                }
+            }
+            size_t len = outLen - offset;
+            if(len > SHA512_DIGEST_LENGTH){
+                len = SHA512_DIGEST_LENGTH;
+            }
+            for(size_t l=0; l<lanes; l++){
+                pbkdf2_store(t[l], out+(k+l)*outLen+offset, len);
+            }
+        }
+    }
+    memzero(ipad, sizeof(ipad));
+    memzero(opad, sizeof(opad));
+    memzero(u, sizeof(u));
+    memzero(s, sizeof(s));
+    memzero(t, sizeof(t));
+    return count*outLen;
+}
@@ -22,9 +22,9 @@ protected:
 public:
 	void begin(){};
     // void beginHMAC(const uint8_t * key, size_t keySize);
-    virtual size_t write(const uint8_t * data, size_t len);
-    virtual size_t write(uint8_t b);
-    virtual size_t end(uint8_t * hash);
+    virtual size_t write(const uint8_t * data, size_t len) = 0;
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t end(uint8_t * hash) = 0;
     // size_t endHMAC(uint8_t * hash);
 };
 
@@ -99,6 +99,13 @@ public:
     size_t end(uint8_t hash[32]);
 };
 
+/********************** Batch SHA-256 ************************/
+/*** count messages of len bytes each, stored one after another ***/
+/*** hashes should fit count * 32 bytes; returns bytes written ***/
+
+int sha256Batch(const uint8_t * data, size_t len, size_t count, uint8_t * hashes);
+int doubleShaBatch(const uint8_t * data, size_t len, size_t count, uint8_t * hashes);
+
 /************************** SHA-512 **************************/
 
 int sha512Hmac(const uint8_t * key, size_t keyLen, const uint8_t * data, size_t dataLen, uint8_t hash[64]);
@@ -112,14 +119,36 @@ int sha512(const String data, uint8_t hash[64]);
 class SHA512 : public HashAlgorithm{
 public:
     SHA512(){ begin(); };
+    ~SHA512();
     void begin();
     void beginHMAC(const uint8_t * key, size_t keySize);
+    // Hashes the key into inner and outer pad states once,
+    // then every beginHMAC() without a key starts from these states.
+    // Saves two SHA-512 compressions per message (PBKDF2 rounds).
+    void prepareHMAC(const uint8_t * key, size_t keySize);
+    void beginHMAC();
     size_t write(const uint8_t * data, size_t len);
     size_t write(uint8_t b);
     size_t end(uint8_t hash[64]);
     size_t endHMAC(uint8_t hmac[64]);
 protected:
     HMAC_SHA512_CTX ctx;
+    uint64_t ipad_digest[8];
+    uint64_t opad_digest[8];
+    bool prepared = false;
 };
 
+/************************** PBKDF2 ***************************/
+/******* pbkdf2_hmac_sha512( password, salt, iterations ) *******/
+
+int pbkdf2_hmac_sha512(const uint8_t * password, size_t passwordLen,
+                       const uint8_t * salt, size_t saltLen,
+                       uint32_t iterations, uint8_t * out, size_t outLen);
+
+/*** count independent derivations, SHA512_LANES at a time in SIMD ***/
+/*** out should fit count * outLen bytes; returns bytes written ***/
+int pbkdf2_hmac_sha512_batch(const uint8_t * const passwords[], const size_t passwordLens[],
+                             const uint8_t * const salts[], const size_t saltLens[],
+                             size_t count, uint32_t iterations, uint8_t * out, size_t outLen);
+
 #endif // __HASH_H__18NLNNCSJ2
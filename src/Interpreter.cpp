@@ -0,0 +1,1171 @@
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+#include "Bitcoin.h"
+#include "Hash.h"
+#include "Conversion.h"
+#include "OpCodes.h"
+#include "utility/trezor/sha2.h"
+
+// consensus limits
+#define MAX_SCRIPT_ELEMENT_SIZE  520
+#define MAX_OPS_PER_SCRIPT       201
+#define MAX_STACK_SIZE           1000
+#define MAX_PUBKEYS_PER_MULTISIG 20
+#define MAX_SCRIPT_SIZE          10000
+#define LOCKTIME_THRESHOLD       500000000
+
+#define SEQUENCE_FINAL                0xffffffff
+#define SEQUENCE_LOCKTIME_DISABLE     (1UL << 31)
+#define SEQUENCE_LOCKTIME_TYPE_FLAG   (1UL << 22)
+#define SEQUENCE_LOCKTIME_MASK        0x0000ffff
+
+#define SIGVERSION_BASE       0
+#define SIGVERSION_WITNESS_V0 1
+
+// ---------------------------------------------------------------- SignatureCache class
+
+SignatureCache::SignatureCache(size_t entries){
+    this->entries = (uint8_t (*)[32]) calloc(entries, 32);
+    if(this->entries != NULL){
+        capacity = entries;
+        ownsBuffer = true;
+    }
+}
+SignatureCache::SignatureCache(uint8_t * buffer, size_t length){
+    entries = (uint8_t (*)[32]) buffer;
+    capacity = (buffer != NULL) ? length / 32 : 0;
+    clear();
+}
+SignatureCache::~SignatureCache(){
+    if(ownsBuffer){
+        free(entries);
+    }
+}
+void SignatureCache::clear(){
+    if(capacity > 0){
+        memset(entries, 0, capacity * 32);
+    }
+    victim = 0;
+}
+// entries are sha256 of everything that goes into ECDSA verification
+void SignatureCache::entry(const uint8_t * pubkey, size_t pubkeyLen,
+                           const uint8_t hash[32],
+                           const uint8_t * sig, size_t sigLen,
+                           uint8_t digest[32]){
+    SHA256 h;
+    h.write((uint8_t)pubkeyLen);
+    h.write(pubkey, pubkeyLen);
+    h.write(hash, 32);
+    h.write(sig, sigLen);
+    h.end(digest);
+}
+static bool sigCacheEmpty(const uint8_t digest[32]){
+    for(int i = 0; i < 32; i++){
+        if(digest[i] != 0){
+            return false;
+        }
+    }
+    return true;
+}
+bool SignatureCache::contains(const uint8_t * pubkey, size_t pubkeyLen,
+                              const uint8_t hash[32],
+                              const uint8_t * sig, size_t sigLen){
+    if(capacity == 0){
+        return false;
+    }
+    uint8_t digest[32];
+    entry(pubkey, pubkeyLen, hash, sig, sigLen, digest);
+    // digests are uniformly distributed, so the first bytes select the slot
+    size_t slot = littleEndianToInt(digest, 4) % capacity;
+    for(int i = 0; i < SIG_CACHE_WAYS; i++){
+        if(memcmp(entries[(slot + i) % capacity], digest, 32) == 0){
+            return true;
+        }
+    }
+    return false;
+}
+void SignatureCache::insert(const uint8_t * pubkey, size_t pubkeyLen,
+                            const uint8_t hash[32],
+                            const uint8_t * sig, size_t sigLen){
+    if(capacity == 0){
+        return;
+    }
+    uint8_t digest[32];
+    entry(pubkey, pubkeyLen, hash, sig, sigLen, digest);
+    size_t slot = littleEndianToInt(digest, 4) % capacity;
+    size_t n = slot;
+    for(int i = 0; i < SIG_CACHE_WAYS; i++){
+        n = (slot + i) % capacity;
+        if(sigCacheEmpty(entries[n]) || memcmp(entries[n], digest, 32) == 0){
+            break;
+        }
+        if(i == SIG_CACHE_WAYS-1){
+            // all candidate slots are taken, evict them in turn
+            n = (slot + victim) % capacity;
+            victim = (victim + 1) % SIG_CACHE_WAYS;
+        }
+    }
+    memcpy(entries[n], digest, 32);
+}
+
+// ---------------------------------------------------------------- stack
+
+struct StackItem{
+    uint8_t * data;
+    size_t len;
+};
+
+// stack of byte arrays, every item owns its data
+class ScriptStack{
+public:
+    ScriptStack(){};
+    ~ScriptStack(){ clear(); };
+    size_t size() const{ return count; };
+    // i-th item from the top, 0 is the top one
+    StackItem &top(size_t i = 0){ return items[count-1-i]; };
+    bool push(const uint8_t * d, size_t len);
+    bool push(bool v);
+    bool pushNum(int64_t v);
+    void pop();
+    // removes top item and passes its data to the caller who should free it
+    StackItem take();
+    // removes i-th item from the top
+    void erase(size_t i);
+    // moves the top item to depth i
+    void sink(size_t i);
+    void swap(size_t i, size_t j);
+    bool copy(ScriptStack &other);
+    void clear();
+private:
+    ScriptStack(const ScriptStack &other);
+    ScriptStack &operator=(const ScriptStack &other);
+    StackItem * items = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+};
+
+bool ScriptStack::push(const uint8_t * d, size_t len){
+    if(count == capacity){
+        size_t cap = (capacity == 0) ? 8 : 2*capacity;
+        StackItem * p = (StackItem *) realloc(items, cap * sizeof(StackItem));
+        if(p == NULL){
+            return false;
+        }
+        items = p;
+        capacity = cap;
+    }
+    uint8_t * buf = NULL;
+    if(len > 0){
+        buf = (uint8_t *) malloc(len);
+        if(buf == NULL){
+            return false;
+        }
+        memcpy(buf, d, len);
+    }
+    items[count].data = buf;
+    items[count].len = len;
+    count++;
+    return true;
+}
+bool ScriptStack::push(bool v){
+    uint8_t one = 1;
+    return v ? push(&one, 1) : push(NULL, 0);
+}
+// minimal little-endian encoding with the sign in the top bit
+bool ScriptStack::pushNum(int64_t v){
+    uint8_t arr[9];
+    size_t len = 0;
+    bool neg = (v < 0);
+    uint64_t a = neg ? -(uint64_t)v : (uint64_t)v;
+    while(a > 0){
+        arr[len++] = a & 0xFF;
+        a >>= 8;
+    }
+    if(len > 0){
+        if(arr[len-1] & 0x80){
+            arr[len++] = neg ? 0x80 : 0;
+        }else if(neg){
+            arr[len-1] |= 0x80;
+        }
+    }
+    return push(arr, len);
+}
+void ScriptStack::pop(){
+    count--;
+    free(items[count].data);
+}
+StackItem ScriptStack::take(){
+    count--;
+    return items[count];
+}
+void ScriptStack::erase(size_t i){
+    size_t n = count-1-i;
+    free(items[n].data);
+    memmove(items+n, items+n+1, (count-n-1)*sizeof(StackItem));
+    count--;
+}
+void ScriptStack::sink(size_t i){
+    StackItem t = items[count-1];
+    size_t n = count-1-i;
+    memmove(items+n+1, items+n, i*sizeof(StackItem));
+    items[n] = t;
+}
+void ScriptStack::swap(size_t i, size_t j){
+    StackItem t = items[count-1-i];
+    items[count-1-i] = items[count-1-j];
+    items[count-1-j] = t;
+}
+bool ScriptStack::copy(ScriptStack &other){
+    clear();
+    for(size_t i = 0; i < other.count; i++){
+        if(!push(other.items[i].data, other.items[i].len)){
+            return false;
+        }
+    }
+    return true;
+}
+void ScriptStack::clear(){
+    while(count > 0){
+        pop();
+    }
+    free(items);
+    items = NULL;
+    capacity = 0;
+}
+
+static bool castToBool(const StackItem &item){
+    for(size_t i = 0; i < item.len; i++){
+        if(item.data[i] != 0){
+            // negative zero is false
+            return !(i == item.len-1 && item.data[i] == 0x80);
+        }
+    }
+    return false;
+}
+
+// decodes a script number no longer than maxLen bytes
+static bool scriptNum(const StackItem &item, size_t maxLen, int64_t * num){
+    if(item.len > maxLen){
+        return false;
+    }
+    if(item.len == 0){
+        *num = 0;
+        return true;
+    }
+    uint64_t v = 0;
+    for(size_t i = 0; i < item.len; i++){
+        v |= ((uint64_t)item.data[i]) << (8*i);
+    }
+    uint8_t last = item.data[item.len-1];
+    if(last & 0x80){
+        v &= ~(((uint64_t)0x80) << (8*(item.len-1)));
+        *num = -(int64_t)v;
+    }else{
+        *num = (int64_t)v;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- script parsing
+
+// reads next opcode at pc and its push data, false if the script is truncated
+static bool getOp(const uint8_t * script, size_t len, size_t * pc,
+                  uint8_t * opcode, const uint8_t ** data, size_t * dataLen){
+    if(*pc >= len){
+        return false;
+    }
+    uint8_t op = script[(*pc)++];
+    size_t n = 0;
+    if(op <= OP_PUSHDATA4){
+        size_t lenBytes = 0;
+        if(op < OP_PUSHDATA1){
+            n = op;
+        }else{
+            lenBytes = (op == OP_PUSHDATA1) ? 1 : ((op == OP_PUSHDATA2) ? 2 : 4);
+            if(len - *pc < lenBytes){
+                return false;
+            }
+            n = littleEndianToInt(script + *pc, lenBytes);
+            *pc += lenBytes;
+        }
+        if(len - *pc < n){
+            return false;
+        }
+    }
+    *opcode = op;
+    *data = script + *pc;
+    *dataLen = n;
+    *pc += n;
+    return true;
+}
+
+static bool isPushOnly(const uint8_t * script, size_t len){
+    size_t pc = 0;
+    uint8_t op;
+    const uint8_t * d;
+    size_t n;
+    while(pc < len){
+        if(!getOp(script, len, &pc, &op, &d, &n)){
+            return false;
+        }
+        if(op > OP_16){
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isP2SH(const uint8_t * script, size_t len){
+    return (len == 23 && script[0] == OP_HASH160 && script[1] == 20 && script[22] == OP_EQUAL);
+}
+
+// <version> <2 to 40 bytes of witness program>
+static bool isWitnessProgram(const uint8_t * script, size_t len,
+                             int * version, const uint8_t ** program, size_t * programLen){
+    if(len < 4 || len > 42){
+        return false;
+    }
+    if(script[0] != OP_0 && (script[0] < OP_1 || script[0] > OP_16)){
+        return false;
+    }
+    if((size_t)script[1] + 2 != len){
+        return false;
+    }
+    *version = (script[0] == OP_0) ? 0 : (script[0] - OP_1 + 1);
+    *program = script + 2;
+    *programLen = len - 2;
+    return true;
+}
+
+// removes every push of data from a legacy scriptCode in place, returns new length
+static size_t findAndDelete(uint8_t * script, size_t len, const uint8_t * data, size_t dataLen){
+    uint8_t prefix[5];
+    size_t prefixLen;
+    if(dataLen < OP_PUSHDATA1){
+        prefix[0] = dataLen;
+        prefixLen = 1;
+    }else if(dataLen <= 0xFF){
+        prefix[0] = OP_PUSHDATA1;
+        prefix[1] = dataLen;
+        prefixLen = 2;
+    }else{
+        prefix[0] = OP_PUSHDATA2;
+        intToLittleEndian(dataLen, prefix+1, 2);
+        prefixLen = 3;
+    }
+    size_t pushLen = prefixLen + dataLen;
+    size_t pc = 0;
+    size_t out = 0;
+    while(pc < len){
+        if(len - pc >= pushLen &&
+           memcmp(script + pc, prefix, prefixLen) == 0 &&
+           memcmp(script + pc + prefixLen, data, dataLen) == 0){
+            pc += pushLen;
+            continue;
+        }
+        size_t start = pc;
+        uint8_t op;
+        const uint8_t * d;
+        size_t n;
+        if(!getOp(script, len, &pc, &op, &d, &n)){
+            pc = len; // keep the truncated tail as is
+        }
+        memmove(script + out, script + start, pc - start);
+        out += pc - start;
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------- signature checks
+
+struct ScriptContext{
+    Transaction * tx;
+    size_t inputIndex;
+    SignatureCache * cache;
+};
+
+// BIP66 strict DER encoding with the sighash type byte at the end
+static bool isValidSignatureEncoding(const uint8_t * sig, size_t len){
+    if(len < 9 || len > 73){
+        return false;
+    }
+    if(sig[0] != 0x30 || sig[1] != len - 3){
+        return false;
+    }
+    size_t lenR = sig[3];
+    if(5 + lenR >= len){
+        return false;
+    }
+    size_t lenS = sig[5 + lenR];
+    if(lenR + lenS + 7 != len){
+        return false;
+    }
+    if(sig[2] != 0x02 || lenR == 0 || (sig[4] & 0x80)){
+        return false;
+    }
+    if(lenR > 1 && sig[4] == 0x00 && !(sig[5] & 0x80)){
+        return false;
+    }
+    if(sig[lenR + 4] != 0x02 || lenS == 0 || (sig[lenR + 6] & 0x80)){
+        return false;
+    }
+    if(lenS > 1 && sig[lenR + 6] == 0x00 && !(sig[lenR + 7] & 0x80)){
+        return false;
+    }
+    return true;
+}
+
+// scriptCode and its SIGHASH_ALL digest, computed on the first use
+struct SigHashState{
+    const uint8_t * code;
+    size_t codeLen;
+    int sigversion;
+    bool ready;
+    uint8_t hash[32];
+};
+
+// 1 if the signature is valid, 0 if not, -1 if its encoding fails the script
+static int checkSig(ScriptContext &ctx, SigHashState &state,
+                    const StackItem &sig, const StackItem &pubkey){
+    if(sig.len == 0){
+        return 0;
+    }
+    if(!isValidSignatureEncoding(sig.data, sig.len)){
+        return -1;
+    }
+    // only SIGHASH_ALL digests are implemented by Transaction
+    if(sig.data[sig.len-1] != SIGHASH_ALL){
+        return 0;
+    }
+    if(!((pubkey.len == 33 && (pubkey.data[0] == 0x02 || pubkey.data[0] == 0x03)) ||
+         (pubkey.len == 65 && pubkey.data[0] == 0x04))){
+        return 0;
+    }
+    if(!state.ready){
+        Script scriptCode(state.code, state.codeLen);
+        if(state.sigversion == SIGVERSION_WITNESS_V0){
+            ctx.tx->sigHashSegwit(ctx.inputIndex, scriptCode, state.hash);
+        }else{
+            ctx.tx->sigHash(ctx.inputIndex, scriptCode, state.hash);
+        }
+        state.ready = true;
+    }
+    if(ctx.cache != NULL && ctx.cache->contains(pubkey.data, pubkey.len, state.hash, sig.data, sig.len)){
+        return 1;
+    }
+    Signature s;
+    if(s.parse(sig.data, sig.len-1) == 0){
+        return 0;
+    }
+    PublicKey pk(pubkey.data);
+    if(!pk.isValid() || !pk.verify(s, state.hash)){
+        return 0;
+    }
+    if(ctx.cache != NULL){
+        ctx.cache->insert(pubkey.data, pubkey.len, state.hash, sig.data, sig.len);
+    }
+    return 1;
+}
+
+// ---------------------------------------------------------------- evaluation
+
+static bool isDisabled(uint8_t op){
+    return ((op >= 126 && op <= 129) ||    // CAT, SUBSTR, LEFT, RIGHT
+            (op >= 131 && op <= 134) ||    // INVERT, AND, OR, XOR
+            op == 141 || op == 142 ||      // 2MUL, 2DIV
+            (op >= 149 && op <= 153));     // MUL, DIV, MOD, LSHIFT, RSHIFT
+}
+
+#define NO_FALSE ((size_t)-1)
+
+static bool evalScript(ScriptStack &stack, const uint8_t * script, size_t len,
+                       ScriptContext &ctx, int sigversion){
+    if(len > MAX_SCRIPT_SIZE){
+        return false;
+    }
+    ScriptStack alt;
+    // IF / ELSE nesting: depth and position of the first false branch
+    size_t condSize = 0;
+    size_t firstFalse = NO_FALSE;
+    size_t pc = 0;
+    size_t codeStart = 0;
+    int opCount = 0;
+    uint8_t * codeCopy = NULL;
+    bool ok = true;
+
+    while(ok && pc < len){
+        bool exec = (firstFalse == NO_FALSE);
+        uint8_t op;
+        const uint8_t * d;
+        size_t n;
+        if(!getOp(script, len, &pc, &op, &d, &n)){
+            ok = false;
+            break;
+        }
+        if(n > MAX_SCRIPT_ELEMENT_SIZE){
+            ok = false;
+            break;
+        }
+        if(op > OP_16 && ++opCount > MAX_OPS_PER_SCRIPT){
+            ok = false;
+            break;
+        }
+        // disabled opcodes fail even in an unexecuted branch
+        if(isDisabled(op)){
+            ok = false;
+            break;
+        }
+        if(exec && op <= OP_PUSHDATA4){
+            ok = stack.push(d, n);
+        }else if(exec || (op >= OP_IF && op <= OP_ENDIF)){
+            switch(op){
+            case OP_1NEGATE:
+            case OP_1: case OP_2: case OP_3: case OP_4: case OP_5:
+            case OP_6: case OP_7: case OP_8: case OP_9: case OP_10:
+            case OP_11: case OP_12: case OP_13: case OP_14: case OP_15: case OP_16:
+                ok = stack.pushNum((int64_t)op - (OP_1 - 1));
+                break;
+            case OP_NOP: case OP_NOP1: case OP_NOP4: case OP_NOP5: case OP_NOP6:
+            case OP_NOP7: case OP_NOP8: case OP_NOP9: case OP_NOP10:
+                break;
+            case OP_CHECKLOCKTIMEVERIFY: {
+                int64_t lock;
+                if(stack.size() < 1 || !scriptNum(stack.top(), 5, &lock) || lock < 0){
+                    ok = false;
+                    break;
+                }
+                uint32_t txLock = ctx.tx->locktime;
+                if(!((txLock < LOCKTIME_THRESHOLD && lock < LOCKTIME_THRESHOLD) ||
+                     (txLock >= LOCKTIME_THRESHOLD && lock >= LOCKTIME_THRESHOLD))){
+                    ok = false;
+                    break;
+                }
+                ok = (lock <= (int64_t)txLock) &&
+                     (ctx.tx->txIns[ctx.inputIndex].sequence != SEQUENCE_FINAL);
+                break;
+            }
+            case OP_CHECKSEQUENCEVERIFY: {
+                int64_t seq;
+                if(stack.size() < 1 || !scriptNum(stack.top(), 5, &seq) || seq < 0){
+                    ok = false;
+                    break;
+                }
+                if(seq & SEQUENCE_LOCKTIME_DISABLE){
+                    break;
+                }
+                uint32_t txSeq = ctx.tx->txIns[ctx.inputIndex].sequence;
+                if(ctx.tx->version < 2 || (txSeq & SEQUENCE_LOCKTIME_DISABLE)){
+                    ok = false;
+                    break;
+                }
+                uint32_t mask = SEQUENCE_LOCKTIME_TYPE_FLAG | SEQUENCE_LOCKTIME_MASK;
+                uint32_t txMasked = txSeq & mask;
+                uint32_t masked = (uint32_t)seq & mask;
+                if(!((txMasked < SEQUENCE_LOCKTIME_TYPE_FLAG && masked < SEQUENCE_LOCKTIME_TYPE_FLAG) ||
+                     (txMasked >= SEQUENCE_LOCKTIME_TYPE_FLAG && masked >= SEQUENCE_LOCKTIME_TYPE_FLAG))){
+                    ok = false;
+                    break;
+                }
+                ok = (masked <= txMasked);
+                break;
+            }
+            case OP_IF:
+            case OP_NOTIF: {
+                bool value = false;
+                if(exec){
+                    if(stack.size() < 1){
+                        ok = false;
+                        break;
+                    }
+                    value = castToBool(stack.top());
+                    if(op == OP_NOTIF){
+                        value = !value;
+                    }
+                    stack.pop();
+                }
+                if(firstFalse == NO_FALSE && !value){
+                    firstFalse = condSize;
+                }
+                condSize++;
+                break;
+            }
+            case OP_ELSE:
+                if(condSize == 0){
+                    ok = false;
+                }else if(firstFalse == NO_FALSE){
+                    firstFalse = condSize-1;
+                }else if(firstFalse == condSize-1){
+                    firstFalse = NO_FALSE;
+                }
+                break;
+            case OP_ENDIF:
+                if(condSize == 0){
+                    ok = false;
+                    break;
+                }
+                condSize--;
+                if(firstFalse == condSize){
+                    firstFalse = NO_FALSE;
+                }
+                break;
+            case OP_VERIFY:
+                if(stack.size() < 1 || !castToBool(stack.top())){
+                    ok = false;
+                }else{
+                    stack.pop();
+                }
+                break;
+            case OP_TOALTSTACK:
+                if(stack.size() < 1){
+                    ok = false;
+                    break;
+                }
+                ok = alt.push(stack.top().data, stack.top().len);
+                stack.pop();
+                break;
+            case OP_FROMALTSTACK:
+                if(alt.size() < 1){
+                    ok = false;
+                    break;
+                }
+                ok = stack.push(alt.top().data, alt.top().len);
+                alt.pop();
+                break;
+            case OP_2DROP:
+                if(stack.size() < 2){
+                    ok = false;
+                    break;
+                }
+                stack.pop();
+                stack.pop();
+                break;
+            case OP_2DUP:
+            case OP_3DUP:
+            case OP_2OVER: {
+                // copy `num` items starting at depth `depth`
+                size_t num = (op == OP_3DUP) ? 3 : 2;
+                size_t depth = (op == OP_2OVER) ? 3 : num-1;
+                if(stack.size() < depth+1){
+                    ok = false;
+                    break;
+                }
+                for(size_t i = 0; ok && i < num; i++){
+                    StackItem t = stack.top(depth);
+                    ok = stack.push(t.data, t.len);
+                }
+                break;
+            }
+            case OP_2ROT: {
+                if(stack.size() < 6){
+                    ok = false;
+                    break;
+                }
+                StackItem a = stack.top(5);
+                StackItem b = stack.top(4);
+                // items are moved, not copied
+                memmove(&stack.top(5), &stack.top(3), 4*sizeof(StackItem));
+                stack.top(1) = a;
+                stack.top(0) = b;
+                break;
+            }
+            case OP_2SWAP:
+                if(stack.size() < 4){
+                    ok = false;
+                    break;
+                }
+                stack.swap(3, 1);
+                stack.swap(2, 0);
+                break;
+            case OP_IFDUP:
+                if(stack.size() < 1){
+                    ok = false;
+                    break;
+                }
+                if(castToBool(stack.top())){
+                    StackItem t = stack.top();
+                    ok = stack.push(t.data, t.len);
+                }
+                break;
+            case OP_DEPTH:
+                ok = stack.pushNum(stack.size());
+                break;
+            case OP_DROP:
+                if(stack.size() < 1){
+                    ok = false;
+                    break;
+                }
+                stack.pop();
+                break;
+            case OP_DUP:
+            case OP_OVER: {
+                size_t depth = (op == OP_DUP) ? 0 : 1;
+                if(stack.size() < depth+1){
+                    ok = false;
+                    break;
+                }
+                StackItem t = stack.top(depth);
+                ok = stack.push(t.data, t.len);
+                break;
+            }
+            case OP_NIP:
+                if(stack.size() < 2){
+                    ok = false;
+                    break;
+                }
+                stack.erase(1);
+                break;
+            case OP_PICK:
+            case OP_ROLL: {
+                int64_t k;
+                if(stack.size() < 2 || !scriptNum(stack.top(), 4, &k)){
+                    ok = false;
+                    break;
+                }
+                stack.pop();
+                if(k < 0 || (uint64_t)k >= stack.size()){
+                    ok = false;
+                    break;
+                }
+                StackItem t = stack.top(k);
+                ok = stack.push(t.data, t.len);
+                if(ok && op == OP_ROLL){
+                    stack.erase(k+1);
+                }
+                break;
+            }
+            case OP_ROT:
+                if(stack.size() < 3){
+                    ok = false;
+                    break;
+                }
+                stack.swap(2, 1);
+                stack.swap(1, 0);
+                break;
+            case OP_SWAP:
+                if(stack.size() < 2){
+                    ok = false;
+                    break;
+                }
+                stack.swap(1, 0);
+                break;
+            case OP_TUCK: {
+                if(stack.size() < 2){
+                    ok = false;
+                    break;
+                }
+                StackItem t = stack.top();
+                ok = stack.push(t.data, t.len);
+                if(ok){
+                    stack.sink(2);
+                }
+                break;
+            }
+            case OP_SIZE:
+                if(stack.size() < 1){
+                    ok = false;
+                    break;
+                }
+                ok = stack.pushNum(stack.top().len);
+                break;
+            case OP_EQUAL:
+            case OP_EQUALVERIFY: {
+                if(stack.size() < 2){
+                    ok = false;
+                    break;
+                }
+                StackItem a = stack.top(1);
+                StackItem b = stack.top(0);
+                bool equal = (a.len == b.len) && (a.len == 0 || memcmp(a.data, b.data, a.len) == 0);
+                stack.pop();
+                stack.pop();
+                if(op == OP_EQUALVERIFY){
+                    ok = equal;
+                }else{
+                    ok = stack.push(equal);
+                }
+                break;
+            }
+            case OP_1ADD: case OP_1SUB: case OP_NEGATE: case OP_ABS:
+            case OP_NOT: case OP_0NOTEQUAL: {
+                int64_t a;
+                if(stack.size() < 1 || !scriptNum(stack.top(), 4, &a)){
+                    ok = false;
+                    break;
+                }
+                switch(op){
+                case OP_1ADD:      a += 1; break;
+                case OP_1SUB:      a -= 1; break;
+                case OP_NEGATE:    a = -a; break;
+                case OP_ABS:       if(a < 0){ a = -a; } break;
+                case OP_NOT:       a = (a == 0); break;
+                case OP_0NOTEQUAL: a = (a != 0); break;
+                }
+                stack.pop();
+                ok = stack.pushNum(a);
+                break;
+            }
+            case OP_ADD: case OP_SUB: case OP_BOOLAND: case OP_BOOLOR:
+            case OP_NUMEQUAL: case OP_NUMEQUALVERIFY: case OP_NUMNOTEQUAL:
+            case OP_LESSTHAN: case OP_GREATERTHAN:
+            case OP_LESSTHANOREQUAL: case OP_GREATERTHANOREQUAL:
+            case OP_MIN: case OP_MAX: {
+                int64_t a, b, r = 0;
+                if(stack.size() < 2 || !scriptNum(stack.top(1), 4, &a) || !scriptNum(stack.top(0), 4, &b)){
+                    ok = false;
+                    break;
+                }
+                switch(op){
+                case OP_ADD:                r = a + b; break;
+                case OP_SUB:                r = a - b; break;
+                case OP_BOOLAND:            r = (a != 0 && b != 0); break;
+                case OP_BOOLOR:             r = (a != 0 || b != 0); break;
+                case OP_NUMEQUAL:           r = (a == b); break;
+                case OP_NUMEQUALVERIFY:     r = (a == b); break;
+                case OP_NUMNOTEQUAL:        r = (a != b); break;
+                case OP_LESSTHAN:           r = (a < b); break;
+                case OP_GREATERTHAN:        r = (a > b); break;
+                case OP_LESSTHANOREQUAL:    r = (a <= b); break;
+                case OP_GREATERTHANOREQUAL: r = (a >= b); break;
+                case OP_MIN:                r = (a < b) ? a : b; break;
+                case OP_MAX:                r = (a > b) ? a : b; break;
+                }
+                stack.pop();
+                stack.pop();
+                if(op == OP_NUMEQUALVERIFY){
+                    ok = (r != 0);
+                }else{
+                    ok = stack.pushNum(r);
+                }
+                break;
+            }
+            case OP_WITHIN: {
+                int64_t x, lo, hi;
+                if(stack.size() < 3 || !scriptNum(stack.top(2), 4, &x) ||
+                   !scriptNum(stack.top(1), 4, &lo) || !scriptNum(stack.top(0), 4, &hi)){
+                    ok = false;
+                    break;
+                }
+                stack.pop();
+                stack.pop();
+                stack.pop();
+                ok = stack.push(lo <= x && x < hi);
+                break;
+            }
+            case OP_RIPEMD160: case OP_SHA1: case OP_SHA256:
+            case OP_HASH160: case OP_HASH256: {
+                if(stack.size() < 1){
+                    ok = false;
+                    break;
+                }
+                StackItem t = stack.top();
+                uint8_t h[32];
+                size_t hLen = 32;
+                switch(op){
+                case OP_RIPEMD160: rmd160(t.data, t.len, h); hLen = 20; break;
+                case OP_SHA1:      sha1_Raw(t.data, t.len, h); hLen = 20; break;
+                case OP_SHA256:    sha256(t.data, t.len, h); break;
+                case OP_HASH160:   hash160(t.data, t.len, h); hLen = 20; break;
+                case OP_HASH256:   doubleSha(t.data, t.len, h); break;
+                }
+                stack.pop();
+                ok = stack.push(h, hLen);
+                break;
+            }
+            case OP_CODESEPARATOR:
+                codeStart = pc;
+                break;
+            case OP_CHECKSIG:
+            case OP_CHECKSIGVERIFY: {
+                if(stack.size() < 2){
+                    ok = false;
+                    break;
+                }
+                StackItem sig = stack.top(1);
+                StackItem pubkey = stack.top(0);
+                SigHashState state = { script + codeStart, len - codeStart, sigversion, false };
+                if(sigversion == SIGVERSION_BASE){
+                    // legacy scriptCode never contains the signature itself
+                    free(codeCopy);
+                    codeCopy = (uint8_t *) malloc(state.codeLen + 1);
+                    if(codeCopy == NULL){
+                        ok = false;
+                        break;
+                    }
+                    memcpy(codeCopy, state.code, state.codeLen);
+                    state.codeLen = findAndDelete(codeCopy, state.codeLen, sig.data, sig.len);
+                    state.code = codeCopy;
+                }
+                int res = checkSig(ctx, state, sig, pubkey);
+                if(res < 0){
+                    ok = false;
+                    break;
+                }
+                stack.pop();
+                stack.pop();
+                if(op == OP_CHECKSIGVERIFY){
+                    ok = (res == 1);
+                }else{
+                    ok = stack.push(res == 1);
+                }
+                break;
+            }
+            case OP_CHECKMULTISIG:
+            case OP_CHECKMULTISIGVERIFY: {
+                // stack: <dummy> <sig>... <nSigs> <pubkey>... <nKeys>
+                int64_t nKeys, nSigs;
+                size_t i = 1;
+                if(stack.size() < i || !scriptNum(stack.top(i-1), 4, &nKeys) ||
+                   nKeys < 0 || nKeys > MAX_PUBKEYS_PER_MULTISIG){
+                    ok = false;
+                    break;
+                }
+                opCount += nKeys;
+                if(opCount > MAX_OPS_PER_SCRIPT){
+                    ok = false;
+                    break;
+                }
+                size_t ikey = ++i;
+                i += nKeys;
+                if(stack.size() < i || !scriptNum(stack.top(i-1), 4, &nSigs) ||
+                   nSigs < 0 || nSigs > nKeys){
+                    ok = false;
+                    break;
+                }
+                size_t isig = ++i;
+                i += nSigs;
+                if(stack.size() < i){
+                    ok = false;
+                    break;
+                }
+                SigHashState state = { script + codeStart, len - codeStart, sigversion, false };
+                if(sigversion == SIGVERSION_BASE){
+                    free(codeCopy);
+                    codeCopy = (uint8_t *) malloc(state.codeLen + 1);
+                    if(codeCopy == NULL){
+                        ok = false;
+                        break;
+                    }
+                    memcpy(codeCopy, state.code, state.codeLen);
+                    for(int64_t k = 0; k < nSigs; k++){
+                        StackItem sig = stack.top(isig+k-1);
+                        state.codeLen = findAndDelete(codeCopy, state.codeLen, sig.data, sig.len);
+                    }
+                    state.code = codeCopy;
+                }
+                bool success = true;
+                while(success && nSigs > 0){
+                    int res = checkSig(ctx, state, stack.top(isig-1), stack.top(ikey-1));
+                    if(res < 0){
+                        ok = false;
+                        break;
+                    }
+                    if(res == 1){
+                        isig++;
+                        nSigs--;
+                    }
+                    ikey++;
+                    nKeys--;
+                    // more signatures left than keys to check them
+                    if(nSigs > nKeys){
+                        success = false;
+                    }
+                }
+                if(!ok){
+                    break;
+                }
+                while(i-- > 1){
+                    stack.pop();
+                }
+                // extra item consumed by the original off-by-one bug, must be empty (BIP147)
+                if(stack.size() < 1 || stack.top().len != 0){
+                    ok = false;
+                    break;
+                }
+                stack.pop();
+                if(op == OP_CHECKMULTISIGVERIFY){
+                    ok = success;
+                }else{
+                    ok = stack.push(success);
+                }
+                break;
+            }
+            default:
+                // OP_RETURN, reserved and unknown opcodes
+                ok = false;
+                break;
+            }
+        }
+        if(stack.size() + alt.size() > MAX_STACK_SIZE){
+            ok = false;
+        }
+    }
+    free(codeCopy);
+    return ok && (condSize == 0);
+}
+
+// ---------------------------------------------------------------- Transaction::verifyInput
+
+static bool stackIsTrue(ScriptStack &stack){
+    return (stack.size() > 0) && castToBool(stack.top());
+}
+
+// BIP141 witness program execution, stack holds the witness items
+static bool verifyWitness(ScriptStack &stack, int version,
+                          const uint8_t * program, size_t programLen,
+                          ScriptContext &ctx){
+    uint8_t p2pkh[25];
+    const uint8_t * script;
+    size_t scriptLen;
+    StackItem witnessScript = { NULL, 0 };
+    if(version != 0){
+        if(version == 1 && programLen == 32){
+            return false; // taproot is not implemented
+        }
+        return true; // reserved for future upgrades
+    }
+    if(programLen == 32){
+        // P2WSH: last item is the script
+        if(stack.size() < 1){
+            return false;
+        }
+        witnessScript = stack.take();
+        uint8_t h[32];
+        sha256(witnessScript.data, witnessScript.len, h);
+        if(memcmp(h, program, 32) != 0){
+            free(witnessScript.data);
+            return false;
+        }
+        script = witnessScript.data;
+        scriptLen = witnessScript.len;
+    }else if(programLen == 20){
+        // P2WPKH: <sig> <pubkey> checked against P2PKH script
+        if(stack.size() != 2){
+            return false;
+        }
+        p2pkh[0] = OP_DUP;
+        p2pkh[1] = OP_HASH160;
+        p2pkh[2] = 20;
+        memcpy(p2pkh+3, program, 20);
+        p2pkh[23] = OP_EQUALVERIFY;
+        p2pkh[24] = OP_CHECKSIG;
+        script = p2pkh;
+        scriptLen = sizeof(p2pkh);
+    }else{
+        return false;
+    }
+    bool ok = true;
+    for(size_t i = 0; i < stack.size(); i++){
+        if(stack.top(i).len > MAX_SCRIPT_ELEMENT_SIZE){
+            ok = false;
+        }
+    }
+    if(ok){
+        ok = evalScript(stack, script, scriptLen, ctx, SIGVERSION_WITNESS_V0);
+    }
+    free(witnessScript.data);
+    // clean stack is required for witness scripts
+    return ok && (stack.size() == 1) && castToBool(stack.top());
+}
+
+// witness is stored as <number of items> then <len><item> for each one
+static bool parseWitness(const uint8_t * data, size_t len, ScriptStack &stack){
+    if(len == 0){
+        return true;
+    }
+    size_t cur = 0;
+    uint64_t num = readVarInt(data, len);
+    cur += lenVarInt(num);
+    for(uint64_t i = 0; i < num; i++){
+        if(cur >= len){
+            return false;
+        }
+        uint64_t l = readVarInt(data+cur, len-cur);
+        cur += lenVarInt(l);
+        if(cur > len || len - cur < l){
+            return false;
+        }
+        if(!stack.push(data+cur, l)){
+            return false;
+        }
+        cur += l;
+    }
+    return (cur == len);
+}
+
+bool Transaction::verifyInput(size_t inputIndex, const Script &scriptPubKey, SignatureCache * cache){
+    if(inputIndex >= inputsNumber){
+        return false;
+    }
+    // CHECKSIGs of the input share sighash data, it's dropped afterwards
+    // unless precomputeSigHash() was called before
+    bool cached = sigHashCached;
+    if(!cached){
+        precomputeSigHash();
+    }
+    bool ok = runInputScripts(inputIndex, scriptPubKey, cache);
+    if(!cached){
+        clearSigHashCache();
+    }
+    return ok;
+}
+
+bool Transaction::runInputScripts(size_t inputIndex, const Script &scriptPubKey, SignatureCache * cache){
+    ScriptContext ctx = { this, inputIndex, cache };
+    const Script &scriptSig = txIns[inputIndex].scriptSig;
+    const Script &witnessProgram = txIns[inputIndex].witnessProgram;
+    const uint8_t * sig = scriptSig.data();
+    size_t sigLen = scriptSig.scriptLen;
+    const uint8_t * spk = scriptPubKey.data();
+    size_t spkLen = scriptPubKey.scriptLen;
+
+    ScriptStack witness;
+    if(!parseWitness(witnessProgram.data(), witnessProgram.scriptLen, witness)){
+        return false;
+    }
+    bool hadWitness = false;
+    ScriptStack stack;
+    ScriptStack p2shStack;
+    if(!evalScript(stack, sig, sigLen, ctx, SIGVERSION_BASE)){
+        return false;
+    }
+    if(isP2SH(spk, spkLen) && !p2shStack.copy(stack)){
+        return false;
+    }
+    if(!evalScript(stack, spk, spkLen, ctx, SIGVERSION_BASE) || !stackIsTrue(stack)){
+        return false;
+    }
+    int version;
+    const uint8_t * program;
+    size_t programLen;
+    if(isWitnessProgram(spk, spkLen, &version, &program, &programLen)){
+        hadWitness = true;
+        // native witness programs require an empty scriptSig
+        if(sigLen != 0 || !verifyWitness(witness, version, program, programLen, ctx)){
+            return false;
+        }
+    }
+    if(isP2SH(spk, spkLen)){
+        if(!isPushOnly(sig, sigLen) || p2shStack.size() < 1){
+            return false;
+        }
+        StackItem redeem = p2shStack.take();
+        bool ok = evalScript(p2shStack, redeem.data, redeem.len, ctx, SIGVERSION_BASE) &&
+                  stackIsTrue(p2shStack);
+        if(ok && isWitnessProgram(redeem.data, redeem.len, &version, &program, &programLen)){
+            hadWitness = true;
+            // scriptSig must be exactly one push of the redeem script
+            ok = (sigLen == redeem.len + 1 && sig[0] == redeem.len) &&
+                 verifyWitness(witness, version, program, programLen, ctx);
+        }
+        free(redeem.data);
+        if(!ok){
+            return false;
+        }
+    }
+    // witness data is not allowed on inputs without witness programs
+    if(!hadWitness && witness.size() > 0){
+        return false;
+    }
+    return true;
+}
@@ -9,15 +9,15 @@
 
 Script::Script(void){
     scriptLen = 0;
-    scriptArray = NULL;
 }
 Script::Script(const uint8_t * buffer, size_t len){
     if(len > MAX_SCRIPT_SIZE){
         return;
     }
-    scriptLen = len;
-    scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-    memcpy(scriptArray, buffer, scriptLen);
+    if(allocate(len)){
+        scriptLen = len;
+        memcpy(data(), buffer, scriptLen);
+    }
 }
 Script::Script(const char * address){
     uint8_t addr[21];
@@ -28,7 +28,7 @@ Script::Script(const char * address){
     // segwit
     if((memcmp(address,"bc", 2) == 0) || (memcmp(address,"tb", 2) == 0)){
         int ver = 0;
-        uint8_t prog[32];
+        uint8_t prog[40];
         size_t prog_len = 0;
         char hrp[] = "bc";
         memcpy(hrp, address, 2);
@@ -37,10 +37,11 @@ Script::Script(const char * address){
             return;
         }
         scriptLen = prog_len + 2;
-        scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-        scriptArray[0] = ver;
-        scriptArray[1] = prog_len; // varint?
-        memcpy(scriptArray+2, prog, prog_len);
+        allocate(scriptLen);
+        uint8_t * arr = data();
+        arr[0] = (ver == 0) ? 0 : (OP_1 + ver - 1);
+        arr[1] = prog_len; // varint?
+        memcpy(arr+2, prog, prog_len);
     }else{ // legacy or nested segwit
         int l = fromBase58Check(address, len, addr, sizeof(addr));
         if(l != 21){ // either wrong checksum or wierd address
@@ -48,70 +49,167 @@ Script::Script(const char * address){
         }
         if((addr[0] == BITCOIN_MAINNET_P2PKH) || (addr[0] == BITCOIN_TESTNET_P2PKH)){
             scriptLen = 25;
-            scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-            scriptArray[0] = OP_DUP;
-            scriptArray[1] = OP_HASH160;
-            scriptArray[2] = 20;
-            memcpy(scriptArray+3, addr+1, 20);
-            scriptArray[23] = OP_EQUALVERIFY;
-            scriptArray[24] = OP_CHECKSIG;
+            allocate(scriptLen);
+            uint8_t * arr = data();
+            arr[0] = OP_DUP;
+            arr[1] = OP_HASH160;
+            arr[2] = 20;
+            memcpy(arr+3, addr+1, 20);
+            arr[23] = OP_EQUALVERIFY;
+            arr[24] = OP_CHECKSIG;
         }
         if((addr[0] == BITCOIN_MAINNET_P2SH) || (addr[0] == BITCOIN_TESTNET_P2SH)){
             scriptLen = 23;
-            scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-            scriptArray[0] = OP_HASH160;
-            scriptArray[1] = 20;
-            memcpy(scriptArray+2, addr+1, 20);
-            scriptArray[22] = OP_EQUAL;
+            allocate(scriptLen);
+            uint8_t * arr = data();
+            arr[0] = OP_HASH160;
+            arr[1] = 20;
+            memcpy(arr+2, addr+1, 20);
+            arr[22] = OP_EQUAL;
         }
     }
 }
-Script::Script(const String address){
+Script::Script(const String &address){
     size_t len = address.length()+1; // +1 for null terminator
     char * buf = (char *)calloc(len, sizeof(uint8_t));
     address.toCharArray(buf, len);
     Script sc(buf);
     free(buf);
-    *this = sc;
+    *this = (Script &&)sc;
 }
-Script::Script(const PublicKey pubkey, int type){
+Script::Script(const PublicKey &pubkey, int type){
     if(type == P2PKH){
         scriptLen = 25;
-        scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-        scriptArray[0] = OP_DUP;
-        scriptArray[1] = OP_HASH160;
-        scriptArray[2] = 20;
+        allocate(scriptLen);
+        uint8_t * arr = data();
+        arr[0] = OP_DUP;
+        arr[1] = OP_HASH160;
+        arr[2] = 20;
         uint8_t sec_arr[65] = { 0 };
         int l = pubkey.sec(sec_arr, sizeof(sec_arr));
-        hash160(sec_arr, l, scriptArray+3);
-        scriptArray[23] = OP_EQUALVERIFY;
-        scriptArray[24] = OP_CHECKSIG;
+        hash160(sec_arr, l, arr+3);
+        arr[23] = OP_EQUALVERIFY;
+        arr[24] = OP_CHECKSIG;
     }
     if(type == P2WPKH){
         scriptLen = 22;
-        scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-        scriptArray[0] = 0x00;
-        scriptArray[1] = 20;
+        allocate(scriptLen);
+        uint8_t * arr = data();
+        arr[0] = 0x00;
+        arr[1] = 20;
         uint8_t sec_arr[65] = { 0 };
         int l = pubkey.sec(sec_arr, sizeof(sec_arr));
-        hash160(sec_arr, l, scriptArray+2);
+        hash160(sec_arr, l, arr+2);
     }
 }
 Script::Script(const Script &other){
-    if(other.scriptLen > 0){
+    if(other.scriptLen > 0 && allocate(other.scriptLen)){
+        scriptLen = other.scriptLen;
+        memcpy(data(), other.data(), scriptLen);
+    }
+}
+Script::Script(Script &&other){
+    if(other.ownsHeap()){
+        scriptArray = other.scriptArray;
+        scriptCapacity = other.scriptCapacity;
+        scriptLen = other.scriptLen;
+        other.scriptArray = NULL;
+        other.scriptCapacity = 0;
+        other.scriptLen = 0;
+    }else if(other.scriptLen > 0 && allocate(other.scriptLen)){
+        // inline or arena memory is copied, the copy doesn't depend on the arena
         scriptLen = other.scriptLen;
-        scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-        memcpy(scriptArray, other.scriptArray, scriptLen);
+        memcpy(data(), other.data(), scriptLen);
     }
 }
 Script::~Script(void){
     clear();
 }
+bool Script::ownsHeap() const{
+    return (scriptArray != NULL) && (arena == NULL || !arena->owns(scriptArray));
+}
 void Script::clear(){
-    if(scriptLen > 0){
+    if(ownsHeap()){
         free(scriptArray);
+    }
+    scriptArray = NULL;
+    scriptCapacity = 0;
+    scriptLen = 0;
+}
+bool Script::allocate(size_t len){
+    scriptArray = NULL;
+    scriptCapacity = 0;
+    if(len <= SCRIPT_INLINE_SIZE){
+        memset(inlineArray, 0, len);
+        return true;
+    }
+    if(arena != NULL){
+        scriptArray = (uint8_t *) arena->alloc(len);
+    }
+    if(scriptArray == NULL){
+        scriptArray = (uint8_t *) calloc( len, sizeof(uint8_t));
+    }
+    if(scriptArray == NULL){
+        return false;
+    }
+    scriptCapacity = len;
+    return true;
+}
+bool Script::reserve(size_t len){
+    if(len <= capacity()){
+        return true;
+    }
+    // geometric growth, so pushing byte by byte is amortized O(1)
+    size_t cap = 2 * capacity();
+    if(cap > MAX_SCRIPT_SIZE){
+        cap = MAX_SCRIPT_SIZE;
+    }
+    if(cap < len){
+        cap = len;
+    }
+    uint8_t * arr = NULL;
+    if(ownsHeap()){
+        arr = (uint8_t *) realloc( scriptArray, cap * sizeof(uint8_t));
+    }else{
+        if(arena != NULL){
+            arr = (uint8_t *) arena->grow(scriptArray, scriptCapacity, cap);
+        }
+        if(arr == NULL){ // no arena or it is full
+            arr = (uint8_t *) malloc( cap * sizeof(uint8_t));
+            if(arr != NULL){
+                memcpy(arr, data(), scriptLen);
+            }
+        }else if(scriptArray == NULL){
+            memcpy(arr, inlineArray, scriptLen);
+        }
+    }
+    if(arr == NULL){
+        return false;
+    }
+    scriptArray = arr;
+    scriptCapacity = cap;
+    return true;
+}
+void Script::useArena(Arena * a){
+    if(a == arena){
+        return;
+    }
+    if(scriptArray == NULL){ // inline
+        arena = a;
+        return;
+    }
+    uint8_t * old = scriptArray;
+    bool heap = ownsHeap();
+    size_t len = scriptLen;
+    arena = a;
+    if(allocate(len)){
+        memcpy(data(), old, len);
+    }else{
         scriptLen = 0;
     }
+    if(heap){
+        free(old);
+    }
 }
 size_t Script::parse(Stream &s){
     clear();
@@ -119,24 +217,27 @@ size_t Script::parse(Stream &s){
     if(l < 0){
         return 0;
     }
-    scriptLen = readVarInt(s);
-    size_t len = lenVarInt(scriptLen);
+    size_t sLen = readVarInt(s);
+    size_t len = lenVarInt(sLen);
 
-    if(l > MAX_SCRIPT_SIZE){
+    if(sLen > MAX_SCRIPT_SIZE || !allocate(sLen)){
         return 0;
     }
-    scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-    len += s.readBytes(scriptArray, scriptLen);
+    scriptLen = sLen;
+    len += s.readBytes(data(), scriptLen);
     return len;
 }
 size_t Script::parse(const uint8_t * buffer){
+    clear();
     size_t l = readVarInt(buffer, 9); // max varint len is 9
     if(l > MAX_SCRIPT_SIZE){
         return 0;
     }
+    if(!allocate(l)){
+        return 0;
+    }
     scriptLen = l;
-    scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-    memcpy(scriptArray, buffer + lenVarInt(l), scriptLen);
+    memcpy(data(), buffer + lenVarInt(l), scriptLen);
     return l + lenVarInt(l);
 }
 size_t Script::parse(const uint8_t * buffer, size_t len){
@@ -145,9 +246,11 @@ size_t Script::parse(const uint8_t * buffer, size_t len){
     if((len < l + lenVarInt(l)) || (l > MAX_SCRIPT_SIZE)){
         return 0;
     }
+    if(!allocate(l)){
+        return 0;
+    }
     scriptLen = l;
-    scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-    memcpy(scriptArray, buffer + lenVarInt(l), scriptLen);
+    memcpy(data(), buffer + lenVarInt(l), scriptLen);
     return l + lenVarInt(l);
 }
 // size_t Script::parseHex(const char * hex){
@@ -158,42 +261,44 @@ size_t Script::parse(const uint8_t * buffer, size_t len){
 // }
 
 int Script::type() const{
+    const uint8_t * arr = data();
     if(
         (scriptLen == 25) && 
-        (scriptArray[0] == OP_DUP) &&
-        (scriptArray[1] == OP_HASH160) &&
-        (scriptArray[2] == 20) &&
-        (scriptArray[23] == OP_EQUALVERIFY) &&
-        (scriptArray[24] == OP_CHECKSIG)
+        (arr[0] == OP_DUP) &&
+        (arr[1] == OP_HASH160) &&
+        (arr[2] == 20) &&
+        (arr[23] == OP_EQUALVERIFY) &&
+        (arr[24] == OP_CHECKSIG)
     ){
         return P2PKH;
     }
     if(
         (scriptLen == 23) &&
-        (scriptArray[0] == OP_HASH160) &&
-        (scriptArray[1] == 20) &&
-        (scriptArray[22] == OP_EQUAL)
+        (arr[0] == OP_HASH160) &&
+        (arr[1] == 20) &&
+        (arr[22] == OP_EQUAL)
     ){
         return P2SH;
     }
     if(
         (scriptLen == 22) &&
-        (scriptArray[0] == 0x00) &&
-        (scriptArray[1] == 20)
+        (arr[0] == 0x00) &&
+        (arr[1] == 20)
     ){
         return P2WPKH;
     }
     if(
         (scriptLen == 34) &&
-        (scriptArray[0] == 0x00) &&
-        (scriptArray[1] == 32)
+        (arr[0] == 0x00) &&
+        (arr[1] == 32)
     ){
         return P2WSH;
     }
     return 0;
 }
 size_t Script::address(char * buffer, size_t len, bool testnet) const{
-    memset(buffer, len, 0);
+    const uint8_t * arr = data();
+    memset(buffer, 0, len);
     if(type() == P2PKH){
         uint8_t addr[21];
         if(testnet){
@@ -201,7 +306,7 @@ size_t Script::address(char * buffer, size_t len, bool testnet) const{
         }else{
             addr[0] = BITCOIN_MAINNET_P2PKH;
         }
-        memcpy(addr+1, scriptArray + 3, 20);
+        memcpy(addr+1, arr + 3, 20);
         char address[40] = { 0 };
         toBase58Check(addr, 21, address, sizeof(address));
         size_t l = strlen(address);
@@ -218,7 +323,7 @@ size_t Script::address(char * buffer, size_t len, bool testnet) const{
         }else{
             addr[0] = BITCOIN_MAINNET_P2SH;
         }
-        memcpy(addr+1, scriptArray + 2, 20);
+        memcpy(addr+1, arr + 2, 20);
         char address[40] = { 0 };
         toBase58Check(addr, 21, address, sizeof(address));
         size_t l = strlen(address);
@@ -228,13 +333,17 @@ size_t Script::address(char * buffer, size_t len, bool testnet) const{
         memcpy(buffer, address, l);
         return l;
     }
-    if(type() == P2WPKH || type() == P2WSH){
+    // witness programs of any version: OP_0..OP_16 followed by 2..40 bytes
+    if(
+        (scriptLen >= 4) && (scriptLen <= 42) &&
+        ((arr[0] == 0x00) || ((arr[0] >= OP_1) && (arr[0] <= OP_16))) &&
+        (arr[1] == scriptLen - 2)
+    ){
         char address[76] = { 0 };
-        char prefix[] = "bc";
-        if(testnet){
-            memcpy(prefix, "tb", 2);
+        int ver = (arr[0] == 0x00) ? 0 : (arr[0] - OP_1 + 1);
+        if(segwit_addr_encode(address, testnet ? "tb" : "bc", ver, arr+2, arr[1]) != 1){
+            return 0;
         }
-        segwit_addr_encode(address, prefix, scriptArray[0], scriptArray+2, scriptArray[1]);
         size_t l = strlen(address);
         if(l > len){
             return 0;
@@ -261,7 +370,7 @@ size_t Script::scriptLength() const{
 size_t Script::serialize(Stream &s) const{
     size_t len = 0;
     writeVarInt(scriptLen, s);
-    s.write(scriptArray, scriptLen);
+    s.write(data(), scriptLen);
     return length();
 }
 size_t Script::serialize(uint8_t array[], size_t len) const{
@@ -270,58 +379,47 @@ size_t Script::serialize(uint8_t array[], size_t len) const{
     }
     size_t l = lenVarInt(scriptLen);
     writeVarInt(scriptLen, array, len);
-    memcpy(array+l, scriptArray, scriptLen);
+    memcpy(array+l, data(), scriptLen);
     return length();
 }
 size_t Script::serializeScript(Stream &s) const{
     size_t len = 0;
-    s.write(scriptArray, scriptLen);
+    s.write(data(), scriptLen);
     return scriptLength();
 }
 size_t Script::serializeScript(uint8_t array[], size_t len) const{
     if(len < scriptLength()){
         return 0;
     }
-    memcpy(array, scriptArray, scriptLen);
+    memcpy(array, data(), scriptLen);
     return scriptLength();
 }
 size_t Script::push(uint8_t code){
-    if(scriptLen+1 > MAX_SCRIPT_SIZE){
+    if(scriptLen+1 > MAX_SCRIPT_SIZE || !reserve(scriptLen+1)){
         clear();
         return 0;
     }
-    if(scriptLen == 0){
-        scriptLen = 1;
-        scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-    }else{
-        scriptLen ++;
-        scriptArray = (uint8_t *) realloc( scriptArray, scriptLen * sizeof(uint8_t));
-    }
-    scriptArray[scriptLen-1] = code;
+    data()[scriptLen] = code;
+    scriptLen ++;
     return scriptLen;
 }
-size_t Script::push(const uint8_t * data, size_t len){
-    if(scriptLen+len > MAX_SCRIPT_SIZE){
+size_t Script::push(const uint8_t * buffer, size_t len){
+    if(scriptLen+len > MAX_SCRIPT_SIZE || !reserve(scriptLen+len)){
         clear();
         return 0;
     }
-    if(scriptLen == 0){
-        scriptArray = (uint8_t *) calloc( len, sizeof(uint8_t));
-    }else{
-        scriptArray = (uint8_t *) realloc( scriptArray, (scriptLen + len) * sizeof(uint8_t));
-    }
-    memcpy(scriptArray + scriptLen, data, len);
+    memcpy(data() + scriptLen, buffer, len);
     scriptLen += len;
     return scriptLen;
 }
-size_t Script::push(const PublicKey pubkey){
+size_t Script::push(const PublicKey &pubkey){
     uint8_t sec[65];
     uint8_t len = pubkey.sec(sec, sizeof(sec));
     push(len);
     push(sec, len);
     return scriptLen;
 }
-size_t Script::push(const Signature sig){//, uint8_t sigType){
+size_t Script::push(const Signature &sig){//, uint8_t sigType){
     uint8_t der[75];
     uint8_t len = sig.der(der, sizeof(der));
     push(len+1);
@@ -330,19 +428,18 @@ size_t Script::push(const Signature sig){//, uint8_t sigType){
     push(SIGHASH_ALL);
     return scriptLen;
 }
-size_t Script::push(const Script sc){
-    uint8_t len = sc.length();
-    uint8_t * tmp;
-    tmp = (uint8_t *)calloc(len, sizeof(uint8_t));
-    sc.serialize(tmp, len);
-    push(tmp, len);
+size_t Script::push(const Script &sc){
+    uint8_t arr[9];
+    size_t l = writeVarInt(sc.scriptLen, arr, sizeof(arr));
+    push(arr, l);
+    push(sc.data(), sc.scriptLen);
     return scriptLen;
 }
 
 Script Script::scriptPubkey() const{
     Script sc;
     uint8_t h[20];
-    hash160(scriptArray, scriptLen, h);
+    hash160(data(), scriptLen, h);
     sc.push(OP_HASH160);
     sc.push(20);
     sc.push(h, 20);
@@ -353,25 +450,51 @@ Script Script::scriptPubkey() const{
 size_t Script::printTo(Print& p) const{
     // p.print("Print!");
     if(scriptLen>0){
-        return toHex(scriptArray, scriptLen, p);
+        return toHex(data(), scriptLen, p);
     }else{
         return 0;
     }
 }
 
 Script &Script::operator=(Script const &other){ 
-    clear();
-    if(other.scriptLen > 0){
-        scriptLen = other.scriptLen;
-        scriptArray = (uint8_t *) calloc( scriptLen, sizeof(uint8_t));
-        memcpy(scriptArray, other.scriptArray, scriptLen);
+    if(this == &other){
+        return *this;
+    }
+    if(other.scriptLen > capacity()){
+        clear();
+        if(!allocate(other.scriptLen)){
+            return *this;
+        }
+    }
+    scriptLen = other.scriptLen;
+    if(other.scriptArray != NULL){
+        memcpy(data(), other.scriptArray, scriptLen);
+    }else{
+        // inline scripts are never longer than the inline buffer
+        memcpy(data(), other.inlineArray, (scriptLen < SCRIPT_INLINE_SIZE) ? scriptLen : SCRIPT_INLINE_SIZE);
     }
     return *this; 
 };
+Script &Script::operator=(Script &&other){
+    if(this == &other){
+        return *this;
+    }
+    if(!other.ownsHeap()){
+        return operator=((const Script &)other);
+    }
+    clear();
+    scriptArray = other.scriptArray;
+    scriptCapacity = other.scriptCapacity;
+    scriptLen = other.scriptLen;
+    other.scriptArray = NULL;
+    other.scriptCapacity = 0;
+    other.scriptLen = 0;
+    return *this;
+}
 
 Script::operator String(){ 
     if(scriptLen>0){
-        return toHex(scriptArray, scriptLen);
+        return toHex(data(), scriptLen);
     }else{
         return "";
     }
@@ -5,13 +5,16 @@
 #include "Hash.h"
 #include "Conversion.h"
 #include "utility/trezor/sha2.h"
+#if BITCOIN_THREADS
+#include <pthread.h>
+#endif
 
 TransactionInput::TransactionInput(void){
     Script empty;
     scriptSig = empty;
 }
 // TODO: don't repeat yourself
-TransactionInput::TransactionInput(byte prev_id[32], uint32_t prev_index, Script script, uint32_t sequence_number){
+TransactionInput::TransactionInput(byte prev_id[32], uint32_t prev_index, const Script &script, uint32_t sequence_number){
     // memcpy(hash, prev_id, 32);
     for(int i=0; i<32; i++){
         hash[i] = prev_id[31-i];
@@ -20,7 +23,7 @@ TransactionInput::TransactionInput(byte prev_id[32], uint32_t prev_index, Script
     scriptSig = script;
     sequence = sequence_number;
 }
-TransactionInput::TransactionInput(byte prev_id[32], uint32_t prev_index, uint32_t sequence_number, Script script){
+TransactionInput::TransactionInput(byte prev_id[32], uint32_t prev_index, uint32_t sequence_number, const Script &script){
     // TransactionInput(prev_id, prev_index, script, sequence_number);
     for(int i=0; i<32; i++){
         hash[i] = prev_id[31-i];
@@ -71,13 +74,13 @@ size_t TransactionInput::parse(byte raw[], size_t len){
     ByteStream s(raw, len);
     return parse(s);
 }
-size_t TransactionInput::length(Script script){
+size_t TransactionInput::length(const Script &script){
     return 32 + 4 + script.length() + 4;
 }
 size_t TransactionInput::length(){
     return length(scriptSig);
 }
-size_t TransactionInput::serialize(Stream &s, Script script){
+size_t TransactionInput::serialize(Stream &s, const Script &script){
     size_t len = 0;
     s.write(hash, 32);
     len += 32;
@@ -94,7 +97,7 @@ size_t TransactionInput::serialize(Stream &s, Script script){
 size_t TransactionInput::serialize(Stream &s){
     return serialize(s, scriptSig);
 }
-size_t TransactionInput::serialize(uint8_t array[], size_t len, Script script){
+size_t TransactionInput::serialize(uint8_t array[], size_t len, const Script &script){
     // TODO: refactor with ByteStream
     if(len < length(script)){
         return 0;
@@ -138,6 +141,19 @@ TransactionInput &TransactionInput::operator=(TransactionInput const &other){
     scriptPubKey = other.scriptPubKey;
     return *this; 
 };
+TransactionInput::TransactionInput(TransactionInput &&other){
+    *this = (TransactionInput &&)other;
+}
+TransactionInput &TransactionInput::operator=(TransactionInput &&other){
+    memcpy(hash, other.hash, 32);
+    outputIndex = other.outputIndex;
+    scriptSig = (Script &&)other.scriptSig;
+    sequence = other.sequence;
+    witnessProgram = (Script &&)other.witnessProgram;
+    amount = other.amount;
+    scriptPubKey = (Script &&)other.scriptPubKey;
+    return *this;
+}
 TransactionInput::operator String(){ 
     size_t len = length();
     uint8_t * ser;
@@ -155,7 +171,7 @@ TransactionOutput::TransactionOutput(void){
     Script empty;
     scriptPubKey = empty;
 }
-TransactionOutput::TransactionOutput(uint64_t send_amount, Script outputScript){
+TransactionOutput::TransactionOutput(uint64_t send_amount, const Script &outputScript){
     amount = send_amount;
     scriptPubKey = outputScript;
 }
@@ -164,12 +180,11 @@ TransactionOutput::TransactionOutput(uint64_t send_amount, char address[]){
     Script sc(address);
     scriptPubKey = sc;
 }
-TransactionOutput::TransactionOutput(uint64_t send_amount, String address){
+TransactionOutput::TransactionOutput(uint64_t send_amount, const String &address){
     amount = send_amount;
-    Script sc(address);
-    scriptPubKey = sc;
+    scriptPubKey = Script(address);
 }
-TransactionOutput::TransactionOutput(Script outputScript, uint64_t send_amount){
+TransactionOutput::TransactionOutput(const Script &outputScript, uint64_t send_amount){
     amount = send_amount;
     scriptPubKey = outputScript;
 }
@@ -178,10 +193,9 @@ TransactionOutput::TransactionOutput(char address[], uint64_t send_amount){
     Script sc(address);
     scriptPubKey = sc;
 }
-TransactionOutput::TransactionOutput(String address, uint64_t send_amount){
+TransactionOutput::TransactionOutput(const String &address, uint64_t send_amount){
     amount = send_amount;
-    Script sc(address);
-    scriptPubKey = sc;
+    scriptPubKey = Script(address);
 }
 size_t TransactionOutput::parse(Stream &s){
     size_t len = 0;
@@ -231,6 +245,15 @@ TransactionOutput &TransactionOutput::operator=(TransactionOutput const &other){
     scriptPubKey = other.scriptPubKey;
     return *this; 
 };
+TransactionOutput::TransactionOutput(TransactionOutput &&other){
+    amount = other.amount;
+    scriptPubKey = (Script &&)other.scriptPubKey;
+}
+TransactionOutput &TransactionOutput::operator=(TransactionOutput &&other){
+    amount = other.amount;
+    scriptPubKey = (Script &&)other.scriptPubKey;
+    return *this;
+}
 TransactionOutput::operator String(){ 
     size_t len = length();
     uint8_t * ser;
@@ -241,18 +264,76 @@ TransactionOutput::operator String(){
     return s;
 };
 
-// TODO: copy constructor, = operator
+// allocates zeroed memory for inputs or outputs, from the arena if there is one
+static void * txAlloc(Arena * arena, size_t count, size_t size){
+    if(size != 0 && count > ((size_t)-1) / size){
+        return NULL;
+    }
+    void * ptr = NULL;
+    if(arena != NULL){
+        ptr = arena->alloc(count * size);
+    }
+    if(ptr == NULL){
+        ptr = calloc(count, size);
+    }
+    return ptr;
+}
+// grows the array by one zeroed element
+static void * txGrow(Arena * arena, void * ptr, size_t count, size_t size){
+    uint8_t * arr;
+    if(arena == NULL || !arena->owns(ptr)){
+        arr = (uint8_t *) realloc(ptr, (count + 1) * size);
+        if(arr != NULL){
+            memset(arr + count * size, 0, size);
+        }
+        return arr;
+    }
+    arr = (uint8_t *) arena->grow(ptr, count * size, (count + 1) * size);
+    if(arr == NULL){ // arena is full, move to the heap
+        arr = (uint8_t *) calloc(count + 1, size);
+        if(arr != NULL){
+            memcpy(arr, ptr, count * size);
+        }
+    }
+    return arr;
+}
+static void txFree(Arena * arena, void * ptr){
+    if(arena == NULL || !arena->owns(ptr)){
+        free(ptr);
+    }
+}
+static void txInUseArena(TransactionInput &txIn, Arena * arena){
+    txIn.scriptSig.useArena(arena);
+    txIn.witnessProgram.useArena(arena);
+    txIn.scriptPubKey.useArena(arena);
+}
+
 Transaction::Transaction(void){
     inputsNumber = 0;
     outputsNumber = 0;
 }
 Transaction::~Transaction(void){
-    if(inputsNumber > 0){
-        free(txIns);
+    clearSigHashCache();
+    clearArrays();
+}
+void Transaction::clearArrays(){
+    // elements live in calloc'ed or arena memory, so destructors are called explicitly
+    for(size_t i=0; i<inputsNumber; i++){
+        txIns[i].~TransactionInput();
+    }
+    for(size_t i=0; i<outputsNumber; i++){
+        txOuts[i].~TransactionOutput();
     }
-    if(outputsNumber > 0){
-        free(txOuts);
+    if(txIns != NULL){
+        txFree(arena, txIns);
     }
+    if(txOuts != NULL){
+        txFree(arena, txOuts);
+    }
+    txIns = NULL;
+    txOuts = NULL;
+    inputsNumber = 0;
+    outputsNumber = 0;
 }
 Transaction::Transaction(Transaction const &other){
     // TODO: just serialize() and parse()
@@ -270,28 +351,58 @@ Transaction::Transaction(Transaction const &other){
     }
 }
 Transaction &Transaction::operator=(Transaction const &other){ 
+    if(this == &other){
+        return *this;
+    }
+    clearSigHashCache();
+    clearArrays();
     version = other.version;
     locktime = other.locktime;
-    inputsNumber = other.inputsNumber;
-    txIns = (TransactionInput *) calloc( inputsNumber, sizeof(TransactionInput));
+    txIns = (TransactionInput *) txAlloc(arena, other.inputsNumber, sizeof(TransactionInput));
+    if(txIns != NULL){
+        inputsNumber = other.inputsNumber;
+    }
     for(int i=0; i<inputsNumber; i++){
+        txInUseArena(txIns[i], arena);
         txIns[i] = other.txIns[i];
     }
-    outputsNumber = other.outputsNumber;
-    txOuts = (TransactionOutput *) calloc( outputsNumber, sizeof(TransactionOutput));
+    txOuts = (TransactionOutput *) txAlloc(arena, other.outputsNumber, sizeof(TransactionOutput));
+    if(txOuts != NULL){
+        outputsNumber = other.outputsNumber;
+    }
     for(int i=0; i<outputsNumber; i++){
+        txOuts[i].scriptPubKey.useArena(arena);
         txOuts[i] = other.txOuts[i];
     }
     return *this; 
 };
+Transaction::Transaction(Transaction &&other){
+    *this = (Transaction &&)other;
+}
+Transaction &Transaction::operator=(Transaction &&other){
+    if(this == &other){
+        return *this;
+    }
+    clearSigHashCache();
+    clearArrays();
+    version = other.version;
+    locktime = other.locktime;
+    arena = other.arena;
+    txIns = other.txIns;
+    txOuts = other.txOuts;
+    inputsNumber = other.inputsNumber;
+    outputsNumber = other.outputsNumber;
+    other.txIns = NULL;
+    other.txOuts = NULL;
+    other.inputsNumber = 0;
+    other.outputsNumber = 0;
+    other.clearSigHashCache();
+    return *this;
+}
 size_t Transaction::parse(Stream &s){
     bool is_segwit = false;
-    if(inputsNumber > 0){
-        free(txIns);
-    }
-    if(outputsNumber > 0){
-        free(txOuts);
-    }
+    clearSigHashCache();
+    clearArrays();
     size_t len = 0;
     size_t l;
     uint8_t arr[4];
@@ -315,13 +426,17 @@ size_t Transaction::parse(Stream &s){
         }
         is_segwit = true;
     }
-    inputsNumber = readVarInt(s);
-    len += lenVarInt(inputsNumber);
-    txIns = ( TransactionInput * )calloc( inputsNumber, sizeof(TransactionInput) );
+    size_t num = readVarInt(s);
+    len += lenVarInt(num);
+    txIns = ( TransactionInput * )txAlloc( arena, num, sizeof(TransactionInput) );
+    if(txIns == NULL){
+        return 0;
+    }
+    inputsNumber = num;
+    // parsed in place, so scripts are allocated only once
     for(int i = 0; i < inputsNumber; i++){
-        TransactionInput txIn;
-        l = txIn.parse(s);
-        txIns[i] = txIn;
+        txInUseArena(txIns[i], arena);
+        l = txIns[i].parse(s);
         if(l == 0){
             return 0;
         }else{
@@ -333,13 +448,16 @@ size_t Transaction::parse(Stream &s){
     if(l < 0){
         return 0;
     }
-    outputsNumber = readVarInt(s);
-    len += lenVarInt(outputsNumber);
-    txOuts = ( TransactionOutput * )calloc( outputsNumber, sizeof(TransactionOutput) );
+    num = readVarInt(s);
+    len += lenVarInt(num);
+    txOuts = ( TransactionOutput * )txAlloc( arena, num, sizeof(TransactionOutput) );
+    if(txOuts == NULL){
+        return 0;
+    }
+    outputsNumber = num;
     for(int i = 0; i < outputsNumber; i++){
-        TransactionOutput txOut;
-        l = txOut.parse(s);
-        txOuts[i] = txOut;
+        txOuts[i].scriptPubKey.useArena(arena);
+        l = txOuts[i].parse(s);
         if(l == 0){
             return 0;
         }else{
@@ -351,25 +469,33 @@ size_t Transaction::parse(Stream &s){
     uint8_t next = s.peek();
     if(is_segwit){
         if(next < 0xf0){
+            uint8_t chunk[64];
             for(int i=0; i<inputsNumber; i++){
-                Script witness_program;
+                Script &witness_program = txIns[i].witnessProgram;
                 size_t numElements = readVarInt(s);
                 uint8_t arr[9];
                 uint8_t l = writeVarInt(numElements, arr, sizeof(arr));
                 witness_program.push(arr, l);
                 for(int j = 0; j < numElements; j++){
-                    Script element;
-                    element.parse(s);
-                    witness_program.push(element);
+                    // element is copied as <len><data> without temporary scripts
+                    size_t elementLen = readVarInt(s);
+                    l = writeVarInt(elementLen, arr, sizeof(arr));
+                    if(witness_program.push(arr, l) == 0){
+                        return 0;
+                    }
+                    while(elementLen > 0){
+                        size_t n = (elementLen < sizeof(chunk)) ? elementLen : sizeof(chunk);
+                        if(s.readBytes(chunk, n) != n || witness_program.push(chunk, n) == 0){
+                            return 0;
+                        }
+                        elementLen -= n;
+                    }
                 }
-                txIns[i].witnessProgram = witness_program;
             }
         }else{
             for(int i=0; i<inputsNumber; i++){
-                Script witness_program;
                 uint8_t arr[] = { 0 };
-                witness_program.push(arr, sizeof(arr));
-                txIns[i].witnessProgram = witness_program;
+                txIns[i].witnessProgram.push(arr, sizeof(arr));
             }
         }
     }
@@ -396,26 +522,84 @@ bool Transaction::isSegwit(){
     }
     return false;
 }
-uint8_t Transaction::addInput(TransactionInput txIn){
+TransactionInput * Transaction::emplaceInput(){
+    clearSigHashCache();
+    TransactionInput * arr;
+    if(inputsNumber == 0){
+        arr = ( TransactionInput * )txAlloc( arena, 1, sizeof(TransactionInput) );
+    }else{
+        arr = ( TransactionInput * )txGrow( arena, txIns, inputsNumber, sizeof(TransactionInput) );
+    }
+    if(arr == NULL){
+        return NULL;
+    }
+    txIns = arr;
     inputsNumber ++;
-    if(inputsNumber == 1){
-        txIns = ( TransactionInput * )calloc( inputsNumber, sizeof(TransactionInput) );
+    TransactionInput * txIn = txIns + inputsNumber - 1;
+    txInUseArena(*txIn, arena);
+    txIn->sequence = 0xffffffff;
+    return txIn;
+}
+TransactionOutput * Transaction::emplaceOutput(){
+    clearSigHashCache();
+    TransactionOutput * arr;
+    if(outputsNumber == 0){
+        arr = ( TransactionOutput * )txAlloc( arena, 1, sizeof(TransactionOutput) );
     }else{
-        txIns = ( TransactionInput * )realloc( txIns, inputsNumber * sizeof(TransactionInput) );
-        memset(txIns+inputsNumber-1, 0, sizeof(TransactionInput));
+        arr = ( TransactionOutput * )txGrow( arena, txOuts, outputsNumber, sizeof(TransactionOutput) );
+    }
+    if(arr == NULL){
+        return NULL;
+    }
+    txOuts = arr;
+    outputsNumber ++;
+    TransactionOutput * txOut = txOuts + outputsNumber - 1;
+    txOut->scriptPubKey.useArena(arena);
+    return txOut;
+}
+uint8_t Transaction::addInput(const TransactionInput &txIn){
+    if(&txIn >= txIns && &txIn < txIns + inputsNumber){
+        // our own input would move when the array grows
+        TransactionInput copy(txIn);
+        return addInput((TransactionInput &&)copy);
+    }
+    TransactionInput * in = emplaceInput();
+    if(in != NULL){
+        *in = txIn;
     }
-    txIns[inputsNumber-1] = txIn;
     return inputsNumber;
 }
-uint8_t Transaction::addOutput(TransactionOutput txOut){
-    outputsNumber ++;
-    if(outputsNumber == 1){
-        txOuts = ( TransactionOutput * )calloc( outputsNumber, sizeof(TransactionOutput) );
-    }else{
-        txOuts = ( TransactionOutput * )realloc( txOuts, outputsNumber * sizeof(TransactionOutput) );
-        memset(txOuts+outputsNumber-1, 0, sizeof(TransactionOutput));
+uint8_t Transaction::addInput(TransactionInput &&txIn){
+    if(&txIn >= txIns && &txIn < txIns + inputsNumber){
+        TransactionInput copy((TransactionInput &&)txIn);
+        return addInput((TransactionInput &&)copy);
+    }
+    TransactionInput * in = emplaceInput();
+    if(in != NULL){
+        *in = (TransactionInput &&)txIn;
+    }
+    return inputsNumber;
+}
+uint8_t Transaction::addOutput(const TransactionOutput &txOut){
+    if(&txOut >= txOuts && &txOut < txOuts + outputsNumber){
+        TransactionOutput copy(txOut);
+        return addOutput((TransactionOutput &&)copy);
+    }
+    TransactionOutput * out = emplaceOutput();
+    if(out != NULL){
+        *out = txOut;
+    }
+    return outputsNumber;
+}
+uint8_t Transaction::addOutput(TransactionOutput &&txOut){
+    if(&txOut >= txOuts && &txOut < txOuts + outputsNumber){
+        TransactionOutput copy((TransactionOutput &&)txOut);
+        return addOutput((TransactionOutput &&)copy);
+    }
+    TransactionOutput * out = emplaceOutput();
+    if(out != NULL){
+        *out = (TransactionOutput &&)txOut;
     }
-    txOuts[outputsNumber-1] = txOut;
     return outputsNumber;
 }
 size_t Transaction::length(){
@@ -472,25 +656,21 @@ size_t Transaction::serialize(Stream &s){
 }
 size_t Transaction::serialize(uint8_t array[], size_t len){
     ByteStream s;
+    s.reserve(length());
     serialize(s);
-    if(s.available() > len){
+    size_t l = s.available();
+    if(l > len){
         return 0;
     }
-    size_t l = s.available();
-    s.readBytes(array, l);
+    memcpy(array, s.data(), l);
     return l;
 }
 
 int Transaction::hash(uint8_t hash[32]){
-    // TODO: refactor with stream hash functions
-    ByteStream s;
+    DoubleSha sha;
+    HashStream s(sha);
     serialize(s, false);
-    size_t len = s.available();
-    uint8_t * arr;
-    arr = (uint8_t *) calloc( len, sizeof(uint8_t));
-    s.readBytes(arr, len);
-    doubleSha(arr, len, hash);
-    free(arr);
+    sha.end(hash);
     return 0;
 }
 
@@ -508,97 +688,152 @@ String Transaction::id(){
     return toHex(id_arr, 32);
 }
 
-int Transaction::sigHash(uint8_t inputIndex, Script scriptPubKey, uint8_t hash[32]){
-    Script empty;
-    ByteStream s;
+void Transaction::clearSigHashCache(){
+    sigHashCached = false;
+    legacyCached = false;
+    if(sigHashSuffix != NULL){
+        free(sigHashSuffix);
+        sigHashSuffix = NULL;
+    }
+    sigHashSuffixLen = 0;
+}
 
+int Transaction::sigHash(size_t inputIndex, const Script &scriptPubKey, uint8_t hash[32]){
+    Script empty;
     uint8_t arr[4];
-    intToLittleEndian(version, arr, 4);
-    s.write(arr, 4);
-    writeVarInt(inputsNumber, s);
-    for(int i=0; i<inputsNumber; i++){
-        if(i != inputIndex){
+
+    DoubleSha sha;
+    if(!sigHashCached){
+        // without precomputeSigHash() everything is hashed on every call
+        intToLittleEndian(version, arr, 4);
+        sha.write(arr, 4);
+        HashStream s(sha);
+        writeVarInt(inputsNumber, s);
+        for(size_t i=0; i<inputIndex; i++){
             txIns[i].serialize(s, empty);
-        }else{
-            txIns[i].serialize(s, scriptPubKey);
         }
+    }else{
+        if(!legacyCached){
+            // serialized outputs are the same for every input,
+            // without memory for them they are hashed on every call
+            sigHashSuffixLen = lenVarInt(outputsNumber);
+            for(int i=0; i<outputsNumber; i++){
+                sigHashSuffixLen += txOuts[i].length();
+            }
+            sigHashSuffix = (uint8_t *) calloc( sigHashSuffixLen, sizeof(uint8_t));
+            if(sigHashSuffix != NULL){
+                size_t l = writeVarInt(outputsNumber, sigHashSuffix, sigHashSuffixLen);
+                for(int i=0; i<outputsNumber; i++){
+                    l += txOuts[i].serialize(sigHashSuffix+l, sigHashSuffixLen-l);
+                }
+                legacyCached = true;
+            }
+            sigHashIndex = inputsNumber; // forces prefix reset
+        }
+        // version is a public field, so the prefix is checked against it
+        if(sigHashIndex > inputIndex || sigHashVersion != version){
+            sigHashPrefix.begin();
+            intToLittleEndian(version, arr, 4);
+            sigHashPrefix.write(arr, 4);
+            HashStream s(sigHashPrefix);
+            writeVarInt(inputsNumber, s);
+            sigHashIndex = 0;
+            sigHashVersion = version;
+        }
+        // inputs before inputIndex are serialized with empty scripts,
+        // so they can be added to the prefix and reused for the next input
+        HashStream prefix(sigHashPrefix);
+        for(; sigHashIndex < inputIndex; sigHashIndex++){
+            txIns[sigHashIndex].serialize(prefix, empty);
+        }
+        sha = sigHashPrefix;
     }
-    writeVarInt(outputsNumber, s);
-    for(int i=0; i<outputsNumber; i++){
-        txOuts[i].serialize(s);
+    HashStream s(sha);
+    txIns[inputIndex].serialize(s, scriptPubKey);
+    for(size_t i=inputIndex+1; i<inputsNumber; i++){
+        txIns[i].serialize(s, empty);
     }
+    if(legacyCached){
+        sha.write(sigHashSuffix, sigHashSuffixLen);
+    }else{
+        writeVarInt(outputsNumber, s);
+        for(int i=0; i<outputsNumber; i++){
+            txOuts[i].serialize(s);
+        }
+    }
+    // locktime is not cached, it can change between calls
     intToLittleEndian(locktime, arr, 4);
-    s.write(arr, 4);
-    uint8_t sighash[] = {1,0,0,0}; // SIGHASH_ALL
-    s.write(sighash, sizeof(sighash));
-
-    size_t len = s.available();
-    uint8_t * buf;
-    buf = (uint8_t *) calloc( len, sizeof(uint8_t));
-    s.readBytes(buf, len);
-    doubleSha(buf, len, hash);
-    free(buf);
+    sha.write(arr, 4);
+    intToLittleEndian(SIGHASH_ALL, arr, 4);
+    sha.write(arr, 4);
+    sha.end(hash);
     return 0;
 }
 
 int Transaction::hashPrevouts(uint8_t hash[32]){
-    ByteStream s;
+    DoubleSha sha;
     for(int i=0; i<inputsNumber; i++){
-        s.write(txIns[i].hash, 32);
+        sha.write(txIns[i].hash, 32);
         uint8_t arr[4];
         intToLittleEndian(txIns[i].outputIndex, arr, 4);
-        s.write(arr, 4);
+        sha.write(arr, 4);
     }
-    size_t len = s.available();
-    uint8_t * buf;
-    buf = (uint8_t *) calloc( len, sizeof(uint8_t));
-    s.readBytes(buf, len);
-    doubleSha(buf, len, hash);
-    free(buf);
+    sha.end(hash);
     return 0;
 }
 
 int Transaction::hashSequence(uint8_t hash[32]){
-    ByteStream s;
+    DoubleSha sha;
     for(int i=0; i<inputsNumber; i++){
         uint8_t arr[4];
         intToLittleEndian(txIns[i].sequence, arr, 4);
-        s.write(arr, 4);
+        sha.write(arr, 4);
     }
-    size_t len = s.available();
-    uint8_t * buf;
-    buf = (uint8_t *) calloc( len, sizeof(uint8_t));
-    s.readBytes(buf, len);
-    doubleSha(buf, len, hash);
-    free(buf);
+    sha.end(hash);
     return 0;
 }
 
 int Transaction::hashOutputs(uint8_t hash[32]){
-    ByteStream s;
+    DoubleSha sha;
+    HashStream s(sha);
     for(int i=0; i<outputsNumber; i++){
         txOuts[i].serialize(s);
     }
-    size_t len = s.available();
-    uint8_t * buf;
-    buf = (uint8_t *) calloc( len, sizeof(uint8_t));
-    s.readBytes(buf, len);
-    doubleSha(buf, len, hash);
-    free(buf);
+    sha.end(hash);
     return 0;
 }
 
-int Transaction::sigHashSegwit(uint8_t inputIndex, Script scriptPubKey, uint8_t hash[32]){
-    ByteStream s;
+int Transaction::precomputeSigHash(){
+    hashPrevouts(cachedPrevouts);
+    hashSequence(cachedSequence);
+    hashOutputs(cachedOutputs);
+    sigHashCached = true;
+    return 0;
+}
+
+int Transaction::sigHashSegwit(size_t inputIndex, const Script &scriptPubKey, uint8_t hash[32]){
+    // without precomputeSigHash() the digests are computed on every call,
+    // so direct changes of txIns and txOuts are always taken into account
+    uint8_t prevouts[32];
+    uint8_t sequence[32];
+    uint8_t outputs[32];
+    if(sigHashCached){
+        memcpy(prevouts, cachedPrevouts, 32);
+        memcpy(sequence, cachedSequence, 32);
+        memcpy(outputs, cachedOutputs, 32);
+    }else{
+        hashPrevouts(prevouts);
+        hashSequence(sequence);
+        hashOutputs(outputs);
+    }
+    DoubleSha sha;
+    HashStream s(sha);
     uint8_t arr[8];
     intToLittleEndian(version, arr, 4);
     s.write(arr, 4);
 
-    uint8_t h[32];
-    hashPrevouts(h);
-    s.write(h, 32);
-    hashSequence(h);
-    s.write(h, 32);
+    s.write(prevouts, 32);
+    s.write(sequence, 32);
 
     s.write(txIns[inputIndex].hash, 32);
     intToLittleEndian(txIns[inputIndex].outputIndex, arr, 4);
@@ -610,39 +845,33 @@ int Transaction::sigHashSegwit(uint8_t inputIndex, Script scriptPubKey, uint8_t
     intToLittleEndian(txIns[inputIndex].sequence, arr, 4);
     s.write(arr, 4);
 
-    hashOutputs(h);
-    s.write(h, 32);
+    s.write(outputs, 32);
 
     intToLittleEndian(locktime, arr, 4);
     s.write(arr, 4);
     uint8_t sighash[] = {1,0,0,0}; // SIGHASH_ALL
     s.write(sighash, sizeof(sighash));
 
-    size_t len = s.available();
-    uint8_t * buf;
-    buf = (uint8_t *) calloc( len, sizeof(uint8_t));
-    s.readBytes(buf, len);
-    doubleSha(buf, len, hash);
-    free(buf);
+    sha.end(hash);
     return 0;
 }
 
-Signature Transaction::signInput(uint8_t inputIndex, PrivateKey pk, Script redeemScript){
-    uint8_t h[32];
+void Transaction::inputSigHash(size_t inputIndex, const PublicKey &pubkey, const Script &redeemScript, bool segwit, uint8_t hash[32]){
     int type = redeemScript.type();
-    bool is_segwit = (isSegwit()) || (type == P2WPKH) || (type == P2WSH);
-    if(is_segwit){
+    if(segwit){
         if((type == P2WPKH) || (type == P2WSH)){
-            Script script_pubkey(pk.publicKey()); // TODO: make it based on redeemScript
-            sigHashSegwit(inputIndex, script_pubkey, h);
+            Script script_pubkey(pubkey); // TODO: make it based on redeemScript
+            sigHashSegwit(inputIndex, script_pubkey, hash);
         }else{
-            sigHashSegwit(inputIndex, redeemScript, h);
+            sigHashSegwit(inputIndex, redeemScript, hash);
         }
     }else{
-        sigHash(inputIndex, redeemScript, h);
+        sigHash(inputIndex, redeemScript, hash);
     }
-    PublicKey pubkey = pk.publicKey();
-    Signature sig = pk.sign(h);
+}
+
+void Transaction::setInputSignature(size_t inputIndex, const PublicKey &pubkey, const Script &redeemScript, bool segwit, const Signature &sig){
+    int type = redeemScript.type();
     uint8_t der[80] = { 0 };
     size_t derLen = sig.der(der, sizeof(der));
     der[derLen] = 1;
@@ -651,11 +880,11 @@ Signature Transaction::signInput(uint8_t inputIndex, PrivateKey pk, Script redee
     uint8_t sec[65] = { 0 };
     size_t secLen = pubkey.sec(sec, sizeof(sec));
 
-    if(is_segwit){
+    if(segwit){
         if((type == P2WPKH) || (type == P2WSH)){
             Script script_sig;
             script_sig.push(redeemScript);
-            txIns[inputIndex].scriptSig = script_sig;
+            txIns[inputIndex].scriptSig = (Script &&)script_sig;
         }else{
             Script empty;
             txIns[inputIndex].scriptSig = empty;
@@ -663,37 +892,398 @@ Signature Transaction::signInput(uint8_t inputIndex, PrivateKey pk, Script redee
 
         uint8_t lenArr[3] = { secLen + derLen + 3, 2, derLen };
         ByteStream s;
+        s.reserve(lenArr[0] + 1);
         s.write(lenArr, 3);
         s.write(der, derLen);
         s.write(secLen);
         s.write(sec, secLen);
         Script sc;
         sc.parse(s);
-        txIns[inputIndex].witnessProgram = sc;
+        txIns[inputIndex].witnessProgram = (Script &&)sc;
     }else{
         uint8_t lenArr[2] = { secLen + derLen + 2, derLen };
         ByteStream s;
+        s.reserve(lenArr[0] + 1);
         s.write(lenArr, 2);
         s.write(der, derLen);
         s.write(secLen);
         s.write(sec, secLen);
         Script sc;
         sc.parse(s);
-        txIns[inputIndex].scriptSig = sc;
+        txIns[inputIndex].scriptSig = (Script &&)sc;
     }
+}
+
+Signature Transaction::signInput(size_t inputIndex, const PrivateKey &pk, const Script &redeemScript){
+    uint8_t h[32];
+    int type = redeemScript.type();
+    bool is_segwit = (isSegwit()) || (type == P2WPKH) || (type == P2WSH);
+    PublicKey pubkey = pk.publicKey();
+    inputSigHash(inputIndex, pubkey, redeemScript, is_segwit, h);
+    Signature sig = pk.sign(h);
+    setInputSignature(inputIndex, pubkey, redeemScript, is_segwit, sig);
     return sig;
 }
 
-Signature Transaction::signInput(uint8_t inputIndex, PrivateKey pk){
+Signature Transaction::signInput(size_t inputIndex, const PrivateKey &pk){
     PublicKey pubkey = pk.publicKey();
     return signInput(inputIndex, pk, pubkey.script());
 }
+
+// Per-input signing job for signAll(). Every input has its own 96-byte slot
+// in buf: 32-byte sighash followed by r and s, so workers never share data
+// and the result doesn't depend on which worker signed which input.
+struct SignJob{
+    const PrivateKey * keys;
+    uint8_t * buf;
+    size_t count;
+    size_t next; // next input to sign, taken atomically
+};
+
+static void * signWorker(void * arg){
+    SignJob * job = (SignJob *)arg;
+    while(true){
+        size_t i = __sync_fetch_and_add(&job->next, 1);
+        if(i >= job->count){
+            return NULL;
+        }
+        uint8_t * slot = job->buf + 96 * i;
+        Signature sig = job->keys[i].sign(slot);
+        sig.bin(slot + 32);
+    }
+}
+
+size_t Transaction::signAll(const PrivateKey * keys, const Script * redeemScripts, unsigned threads){
+    if(inputsNumber == 0){
+        return 0;
+    }
+    uint8_t * buf = (uint8_t *) calloc(inputsNumber, 97); // slot + segwit flag
+    if(buf == NULL){
+        return 0;
+    }
+    uint8_t * segwit = buf + 96 * inputsNumber;
+    // caches are kept only for this call, unless precomputeSigHash() was called before
+    bool cached = sigHashCached;
+    if(!cached){
+        precomputeSigHash();
+    }
+    // Sighashes in input order on this thread, they share the cached midstates.
+    // Signing an input with a witness makes the transaction segwit,
+    // so every following input uses BIP143 just like with signInput().
+    bool is_segwit = isSegwit();
+    for(size_t i = 0; i < inputsNumber; i++){
+        PublicKey pubkey = keys[i].publicKey();
+        Script script = (redeemScripts == NULL) ? pubkey.script() : redeemScripts[i];
+        int type = script.type();
+        is_segwit = is_segwit || (type == P2WPKH) || (type == P2WSH);
+        segwit[i] = is_segwit;
+        inputSigHash(i, pubkey, script, is_segwit, buf + 96 * i);
+    }
+    if(!cached){
+        clearSigHashCache();
+    }
+
+    SignJob job = { keys, buf, inputsNumber, 0 };
+#if BITCOIN_THREADS
+    // the first signature builds lazily precomputed curve tables
+    // before any worker touches them
+    job.next = 1;
+    Signature first = keys[0].sign(buf);
+    first.bin(buf + 32);
+    if(threads > inputsNumber - 1){
+        threads = inputsNumber - 1;
+    }
+    pthread_t * workers = NULL;
+    unsigned started = 0;
+    if(threads > 1){
+        workers = (pthread_t *) calloc(threads - 1, sizeof(pthread_t));
+    }
+    // if a thread can't be created the remaining work is done by fewer workers
+    while(workers != NULL && started < threads - 1){
+        if(pthread_create(&workers[started], NULL, signWorker, &job) != 0){
+            break;
+        }
+        started++;
+    }
+    signWorker(&job);
+    for(unsigned i = 0; i < started; i++){
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+#else
+    (void)threads;
+    signWorker(&job);
+#endif
+
+    for(size_t i = 0; i < inputsNumber; i++){
+        PublicKey pubkey = keys[i].publicKey();
+        Script script = (redeemScripts == NULL) ? pubkey.script() : redeemScripts[i];
+        uint8_t * slot = buf + 96 * i;
+        Signature sig(slot + 32, slot + 64);
+        setInputSignature(i, pubkey, script, segwit[i], sig);
+    }
+    free(buf);
+    return inputsNumber;
+}
+
 Transaction::operator String(){ 
-    size_t len = length();
-    uint8_t * ser;
-    ser = (uint8_t *)calloc(len, sizeof(uint8_t));
-    serialize(ser, len);
-    String s = toHex(ser, len);
-    free(ser);
-    return s;
-};
\ No newline at end of file
+    ByteStream s;
+    s.reserve(length());
+    serialize(s);
+    return toHex(s.data(), s.available());
+};
+
+// ---------------------------------------------------------------- TransactionView class
+
+// reads a varint at pos, returns false if it doesn't fit in len
+static bool viewVarInt(const uint8_t * raw, size_t len, size_t * pos, uint64_t * value){
+    if(*pos >= len){
+        return false;
+    }
+    uint8_t l = 1;
+    if(raw[*pos] >= 0xfd){
+        l += (1 << (raw[*pos] - 0xfc));
+    }
+    if(len - *pos < l){
+        return false;
+    }
+    *value = readVarInt(raw + *pos, l);
+    *pos += l;
+    return true;
+}
+// skips a varint-prefixed byte sequence
+static bool viewSkipBytes(const uint8_t * raw, size_t len, size_t * pos, ByteSpan * span){
+    uint64_t l;
+    if(!viewVarInt(raw, len, pos, &l) || l > len - *pos){
+        return false;
+    }
+    if(span != NULL){
+        span->data = raw + *pos;
+        span->len = l;
+    }
+    *pos += l;
+    return true;
+}
+// skips one witness stack
+static bool viewSkipWitness(const uint8_t * raw, size_t len, size_t * pos){
+    uint64_t n;
+    if(!viewVarInt(raw, len, pos, &n)){
+        return false;
+    }
+    for(uint64_t i=0; i<n; i++){
+        if(!viewSkipBytes(raw, len, pos, NULL)){
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t TransactionView::parse(const uint8_t * data, size_t len){
+    uint64_t n;
+    size_t pos = 4;
+
+    raw = NULL;
+    rawLen = 0;
+    hashed = false;
+    witnessHashed = false;
+    if(len < 10){
+        return 0;
+    }
+    version = littleEndianToInt(data, 4);
+    segwit = (data[4] == 0x00);
+    if(segwit){
+        if(data[5] != 0x01){
+            return 0; // wrong segwit flag
+        }
+        pos += 2;
+    }
+    if(!viewVarInt(data, len, &pos, &n)){
+        return 0;
+    }
+    inputsNumber = n;
+    inputsOffset = pos;
+    for(uint64_t i=0; i<n; i++){
+        if(len - pos < 36){
+            return 0;
+        }
+        pos += 36;
+        if(!viewSkipBytes(data, len, &pos, NULL) || len - pos < 4){
+            return 0;
+        }
+        pos += 4;
+    }
+    if(!viewVarInt(data, len, &pos, &n)){
+        return 0;
+    }
+    outputsNumber = n;
+    outputsOffset = pos;
+    for(uint64_t i=0; i<n; i++){
+        if(len - pos < 8){
+            return 0;
+        }
+        pos += 8;
+        if(!viewSkipBytes(data, len, &pos, NULL)){
+            return 0;
+        }
+    }
+    witnessOffset = pos;
+    if(segwit){
+        for(size_t i=0; i<inputsNumber; i++){
+            if(!viewSkipWitness(data, len, &pos)){
+                return 0;
+            }
+        }
+    }
+    if(len - pos < 4){
+        return 0;
+    }
+    locktimeOffset = pos;
+    locktime = littleEndianToInt(data + pos, 4);
+    pos += 4;
+
+    lastInput = 0;
+    lastInputOffset = inputsOffset;
+    lastOutput = 0;
+    lastOutputOffset = outputsOffset;
+    lastWitness = 0;
+    lastWitnessOffset = witnessOffset;
+
+    raw = data;
+    rawLen = pos;
+    return pos;
+}
+TransactionInputView TransactionView::input(size_t index) const{
+    TransactionInputView in;
+    memset(&in, 0, sizeof(in));
+    if(raw == NULL || index >= inputsNumber){
+        return in;
+    }
+    // offsets are checked by parse()
+    size_t i = 0;
+    size_t pos = inputsOffset;
+    if(index >= lastInput){
+        i = lastInput;
+        pos = lastInputOffset;
+    }
+    for(; i<index; i++){
+        pos += 36;
+        viewSkipBytes(raw, rawLen, &pos, NULL);
+        pos += 4;
+    }
+    lastInput = index;
+    lastInputOffset = pos;
+    in.hash = raw + pos;
+    in.outputIndex = littleEndianToInt(raw + pos + 32, 4);
+    pos += 36;
+    viewSkipBytes(raw, rawLen, &pos, &in.scriptSig);
+    in.sequence = littleEndianToInt(raw + pos, 4);
+    if(segwit){
+        i = 0;
+        pos = witnessOffset;
+        if(index >= lastWitness){
+            i = lastWitness;
+            pos = lastWitnessOffset;
+        }
+        for(; i<index; i++){
+            viewSkipWitness(raw, rawLen, &pos);
+        }
+        lastWitness = index;
+        lastWitnessOffset = pos;
+        size_t start = pos;
+        viewSkipWitness(raw, rawLen, &pos);
+        in.witness.data = raw + start;
+        in.witness.len = pos - start;
+    }
+    return in;
+}
+TransactionOutputView TransactionView::output(size_t index) const{
+    TransactionOutputView out;
+    memset(&out, 0, sizeof(out));
+    if(raw == NULL || index >= outputsNumber){
+        return out;
+    }
+    size_t i = 0;
+    size_t pos = outputsOffset;
+    if(index >= lastOutput){
+        i = lastOutput;
+        pos = lastOutputOffset;
+    }
+    for(; i<index; i++){
+        pos += 8;
+        viewSkipBytes(raw, rawLen, &pos, NULL);
+    }
+    lastOutput = index;
+    lastOutputOffset = pos;
+    out.amount = littleEndianToInt(raw + pos, 8);
+    pos += 8;
+    viewSkipBytes(raw, rawLen, &pos, &out.scriptPubKey);
+    return out;
+}
+ByteSpan TransactionView::witnessItem(size_t inputIndex, size_t itemIndex) const{
+    ByteSpan item = { NULL, 0 };
+    TransactionInputView in = input(inputIndex);
+    if(in.witness.len == 0){
+        return item;
+    }
+    size_t pos = 0;
+    uint64_t n;
+    viewVarInt(in.witness.data, in.witness.len, &pos, &n);
+    if(itemIndex >= n){
+        return item;
+    }
+    for(size_t i=0; i<=itemIndex; i++){
+        viewSkipBytes(in.witness.data, in.witness.len, &pos, &item);
+    }
+    return item;
+}
+int TransactionView::hash(uint8_t hash[32]) const{
+    if(raw == NULL){
+        return 0;
+    }
+    if(!hashed){
+        // version, inputs, outputs and locktime without marker, flag and witness
+        DoubleSha sha;
+        sha.write(raw, 4);
+        sha.write(raw + (segwit ? 6 : 4), witnessOffset - (segwit ? 6 : 4));
+        sha.write(raw + locktimeOffset, 4);
+        sha.end(txHash);
+        hashed = true;
+    }
+    memcpy(hash, txHash, 32);
+    return 32;
+}
+int TransactionView::id(uint8_t id_arr[32]) const{
+    uint8_t h[32];
+    int l = hash(h);
+    for(int i=0; i<32; i++){ // flip
+        id_arr[i] = h[31-i];
+    }
+    return l;
+}
+String TransactionView::id() const{
+    uint8_t id_arr[32];
+    id(id_arr);
+    return toHex(id_arr, 32);
+}
+int TransactionView::witnessHash(uint8_t hash[32]) const{
+    if(raw == NULL){
+        return 0;
+    }
+    if(!segwit){
+        return this->hash(hash);
+    }
+    if(!witnessHashed){
+        doubleSha(raw, rawLen, wtxHash);
+        witnessHashed = true;
+    }
+    memcpy(hash, wtxHash, 32);
+    return 32;
+}
+int TransactionView::witnessId(uint8_t id_arr[32]) const{
+    uint8_t h[32];
+    int l = witnessHash(h);
+    for(int i=0; i<32; i++){ // flip
+        id_arr[i] = h[31-i];
+    }
+    return l;
+}
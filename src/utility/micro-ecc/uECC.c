@@ -182,6 +182,16 @@ static cmpresult_t uECC_vli_cmp_unsafe(const uECC_word_t *left,
     #include "asm_avr.inc"
 #endif
 
+#if uECC_SECP256K1_INT128 && !(uECC_SUPPORTS_secp256k1 && (uECC_WORD_SIZE == 8) && \
+        SUPPORTS_INT128 && (uECC_OPTIMIZATION_LEVEL > 0))
+    #undef uECC_SECP256K1_INT128
+    #define uECC_SECP256K1_INT128 0
+#endif
+
+#if uECC_SECP256K1_INT128
+    #include "secp256k1_int128.inc"
+#endif
+
 #if default_RNG_defined
 static uECC_RNG_Function g_rng_function = &default_RNG;
 #else
@@ -620,6 +630,12 @@ uECC_VLI_API void uECC_vli_modMult_fast(uECC_word_t *result,
                                         const uECC_word_t *right,
                                         uECC_Curve curve) {
     uECC_word_t product[2 * uECC_MAX_WORDS];
+#if uECC_SECP256K1_INT128
+    if (curve->mmod_fast == &vli_mmod_fast_secp256k1) {
+        secp256k1_mult_int128(result, left, right);
+        return;
+    }
+#endif
     uECC_vli_mult(product, left, right, curve->num_words);
 #if (uECC_OPTIMIZATION_LEVEL > 0)
     curve->mmod_fast(result, product);
@@ -646,6 +662,12 @@ uECC_VLI_API void uECC_vli_modSquare_fast(uECC_word_t *result,
                                           const uECC_word_t *left,
                                           uECC_Curve curve) {
     uECC_word_t product[2 * uECC_MAX_WORDS];
+#if uECC_SECP256K1_INT128
+    if (curve->mmod_fast == &vli_mmod_fast_secp256k1) {
+        secp256k1_square_int128(result, left);
+        return;
+    }
+#endif
     uECC_vli_square(product, left, curve->num_words);
 #if (uECC_OPTIMIZATION_LEVEL > 0)
     curve->mmod_fast(result, product);
@@ -696,6 +718,14 @@ uECC_VLI_API void uECC_vli_modInv(uECC_word_t *result,
     uECC_word_t a[uECC_MAX_WORDS], b[uECC_MAX_WORDS], u[uECC_MAX_WORDS], v[uECC_MAX_WORDS];
     cmpresult_t cmpResult;
 
+#if uECC_SECP256K1_INT128
+    /* Fermat inversion: constant time, and no slower than the binary algorithm below */
+    if (num_words == 4 && uECC_vli_equal(mod, secp256k1_p_int128, 4)) {
+        secp256k1_inv_int128(result, input);
+        return;
+    }
+#endif
+
     if (uECC_vli_isZero(input, num_words)) {
         uECC_vli_clear(result, num_words);
         return;
@@ -913,19 +943,704 @@ static uECC_word_t regularize_k(const uECC_word_t * const k,
     return carry;
 }
 
-static uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
-                                               uECC_word_t *private_key,
-                                               uECC_Curve curve) {
+#if uECC_SUPPORTS_secp256k1 && (uECC_SECP256K1_FIXED_BASE || uECC_SECP256K1_GLV)
+
+/* Helpers for the table-based secp256k1 multiplications below. */
+
+#define MULTIPLES_MAX 32
+
+/* dest = mask ? src : dest, where mask is 0 or all ones */
+static void vli_cmov(uECC_word_t *dest,
+                     const uECC_word_t *src,
+                     uECC_word_t mask,
+                     wordcount_t num_words) {
+    wordcount_t i;
+    for (i = 0; i < num_words; ++i) {
+        dest[i] = (dest[i] & ~mask) | (src[i] & mask);
+    }
+}
+
+/* Computes (step * j + 1) * point for j < count in Jacobian coordinates (X[j], Y[j], Z[j]),
+where step is 1 (all multiples) or 2 (odd multiples) and 1 < count <= MULTIPLES_MAX. The chain
+is built with co-Z additions. prod[j] is set to Z[0] * ... * Z[j] for EccPoint_chain_affine(). */
+static void EccPoint_chain(uECC_word_t (*X)[uECC_MAX_WORDS],
+                           uECC_word_t (*Y)[uECC_MAX_WORDS],
+                           uECC_word_t (*Z)[uECC_MAX_WORDS],
+                           uECC_word_t (*prod)[uECC_MAX_WORDS],
+                           const uECC_word_t *point,
+                           int count,
+                           int step,
+                           uECC_Curve curve) {
+    uECC_word_t px[uECC_MAX_WORDS];
+    uECC_word_t py[uECC_MAX_WORDS];
+    uECC_word_t dx[uECC_MAX_WORDS];
+    uECC_word_t dy[uECC_MAX_WORDS];
+    uECC_word_t z[uECC_MAX_WORDS];
+    uECC_word_t tz[uECC_MAX_WORDS];
+    uECC_word_t *ax, *ay, *cx, *cy;
+    wordcount_t num_words = curve->num_words;
+    int j;
+
+    uECC_vli_set(X[0], point, num_words);
+    uECC_vli_set(Y[0], point + num_words, num_words);
+    uECC_vli_clear(Z[0], num_words);
+    Z[0][0] = 1;
+
+    /* d = 2 * point, then bring point to the same Z */
+    uECC_vli_set(dx, X[0], num_words);
+    uECC_vli_set(dy, Y[0], num_words);
+    uECC_vli_set(z, Z[0], num_words);
+    curve->double_jacobian(dx, dy, z, curve);
+    uECC_vli_set(px, X[0], num_words);
+    uECC_vli_set(py, Y[0], num_words);
+    apply_z(px, py, z, curve);
+
+    /* the chain adds point to 2 * point for all multiples,
+       or 2 * point to point for odd ones */
+    if (step == 1) {
+        ax = px, ay = py, cx = dx, cy = dy;
+        uECC_vli_set(X[1], dx, num_words);
+        uECC_vli_set(Y[1], dy, num_words);
+        uECC_vli_set(Z[1], z, num_words);
+        j = 2;
+    } else {
+        ax = dx, ay = dy, cx = px, cy = py;
+        j = 1;
+    }
+    for (; j < count; ++j) {
+        uECC_vli_modSub(tz, cx, ax, curve->p, num_words); /* Z = x2 - x1 */
+        XYcZ_add(ax, ay, cx, cy, curve);
+        uECC_vli_modMult_fast(z, z, tz, curve);
+        uECC_vli_set(X[j], cx, num_words);
+        uECC_vli_set(Y[j], cy, num_words);
+        uECC_vli_set(Z[j], z, num_words);
+    }
+
+    uECC_vli_set(prod[0], Z[0], num_words);
+    for (j = 1; j < count; ++j) {
+        uECC_vli_modMult_fast(prod[j], prod[j - 1], Z[j], curve);
+    }
+}
+
+/* Writes the chain from EccPoint_chain() to out in affine coordinates, given
+inv = 1 / prod[count - 1] (Montgomery's trick). Rows of out are num_words * 2 long. */
+static void EccPoint_chain_affine(uECC_word_t *out,
+                                  uECC_word_t (*X)[uECC_MAX_WORDS],
+                                  uECC_word_t (*Y)[uECC_MAX_WORDS],
+                                  const uECC_word_t (*Z)[uECC_MAX_WORDS],
+                                  const uECC_word_t (*prod)[uECC_MAX_WORDS],
+                                  const uECC_word_t *inv,
+                                  int count,
+                                  uECC_Curve curve) {
+    uECC_word_t z[uECC_MAX_WORDS];
+    uECC_word_t tz[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    int j;
+
+    uECC_vli_set(z, inv, num_words);
+    for (j = count - 1; j > 0; --j) {
+        uECC_vli_modMult_fast(tz, z, prod[j - 1], curve); /* 1 / Z[j] */
+        uECC_vli_modMult_fast(z, z, Z[j], curve);
+        apply_z(X[j], Y[j], tz, curve);
+    }
+
+    for (j = 0; j < count; ++j) {
+        uECC_vli_set(out + j * 2 * num_words, X[j], num_words);
+        uECC_vli_set(out + (j * 2 + 1) * num_words, Y[j], num_words);
+    }
+}
+
+/* Fills out[j] with (step * j + 1) * point in affine coordinates for j < count, where step is
+1 (all multiples) or 2 (odd multiples) and 1 < count <= MULTIPLES_MAX. Rows of out are
+num_words * 2 long. The chain is built with co-Z additions and normalized with one inversion. */
+static void EccPoint_multiples(uECC_word_t *out,
+                               const uECC_word_t *point,
+                               int count,
+                               int step,
+                               uECC_Curve curve) {
+    uECC_word_t X[MULTIPLES_MAX][uECC_MAX_WORDS];
+    uECC_word_t Y[MULTIPLES_MAX][uECC_MAX_WORDS];
+    uECC_word_t Z[MULTIPLES_MAX][uECC_MAX_WORDS];
+    uECC_word_t prod[MULTIPLES_MAX][uECC_MAX_WORDS];
+    uECC_word_t inv[uECC_MAX_WORDS];
+
+    EccPoint_chain(X, Y, Z, prod, point, count, step, curve);
+    uECC_vli_modInv(inv, prod[count - 1], curve->p, curve->num_words);
+    EccPoint_chain_affine(out, X, Y, (const uECC_word_t (*)[uECC_MAX_WORDS])Z,
+                          (const uECC_word_t (*)[uECC_MAX_WORDS])prod, inv, count, curve);
+}
+
+/* out = table[digit - 1], or zeroes if digit is 0. Every entry is read, so the memory access
+pattern doesn't depend on digit. */
+static void EccPoint_lookup(uECC_word_t *out,
+                            const uECC_word_t *table,
+                            int count,
+                            uECC_word_t digit,
+                            wordcount_t num_words) {
+    uECC_word_t mask;
+    int j;
+
+    uECC_vli_clear(out, num_words * 2);
+    for (j = 0; j < count; ++j) {
+        mask = (uECC_word_t)((digit ^ (uECC_word_t)(j + 1)) - 1) >> (uECC_WORD_BITS - 1);
+        mask = -mask;
+        vli_cmov(out, table + j * 2 * num_words, mask, num_words * 2);
+    }
+}
+
+/* (rx, ry, z) += point if add_mask is all ones. *infinity is all ones while the accumulator is
+the point at infinity and is updated accordingly. The same operations run whatever the masks
+are. The accumulator must not be equal to +-point. */
+static void EccPoint_add_masked(uECC_word_t *rx,
+                                uECC_word_t *ry,
+                                uECC_word_t *z,
+                                uECC_word_t *infinity,
+                                const uECC_word_t *point,
+                                uECC_word_t add_mask,
+                                uECC_Curve curve) {
+    uECC_word_t sx[uECC_MAX_WORDS];
+    uECC_word_t sy[uECC_MAX_WORDS];
+    uECC_word_t sz[uECC_MAX_WORDS];
+    uECC_word_t tx[uECC_MAX_WORDS];
+    uECC_word_t ty[uECC_MAX_WORDS];
+    uECC_word_t mask;
+    wordcount_t num_words = curve->num_words;
+
+    /* s = r + point, meaningless if r is infinity */
+    uECC_vli_set(sx, rx, num_words);
+    uECC_vli_set(sy, ry, num_words);
+    uECC_vli_set(tx, point, num_words);
+    uECC_vli_set(ty, point + num_words, num_words);
+    apply_z(tx, ty, z, curve);
+    uECC_vli_modSub(sz, sx, tx, curve->p, num_words); /* Z = x2 - x1 */
+    XYcZ_add(tx, ty, sx, sy, curve);
+    uECC_vli_modMult_fast(sz, z, sz, curve);
+
+    mask = add_mask & ~*infinity;
+    vli_cmov(rx, sx, mask, num_words);
+    vli_cmov(ry, sy, mask, num_words);
+    vli_cmov(z, sz, mask, num_words);
+
+    mask = add_mask & *infinity;
+    uECC_vli_clear(sz, num_words);
+    sz[0] = 1;
+    vli_cmov(rx, point, mask, num_words);
+    vli_cmov(ry, point + num_words, mask, num_words);
+    vli_cmov(z, sz, mask, num_words);
+
+    *infinity &= ~add_mask;
+}
+
+#endif /* uECC_SUPPORTS_secp256k1 && (uECC_SECP256K1_FIXED_BASE || uECC_SECP256K1_GLV) */
+
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_FIXED_BASE
+
+/* Fixed-base multiplication for secp256k1.
+The scalar is split into 64 4-bit windows and g_fixed_base[i][j] holds (j + 1) * 16^i * G in
+affine coordinates, so k * G costs 64 mixed additions and no doublings. Table entries are picked
+with a full scan and masks, so the memory access pattern doesn't depend on the scalar.
+The table is built on the first call; it is not protected by a lock, so multithreaded code should
+compute one public key before starting its threads. */
+#define FIXED_BASE_WINDOWS 64
+#define FIXED_BASE_POINTS 15
+
+static uECC_word_t g_fixed_base[FIXED_BASE_WINDOWS][FIXED_BASE_POINTS][num_words_secp256k1 * 2];
+static volatile uint8_t g_fixed_base_ready = 0;
+
+static void fixed_base_build(void) {
+    uECC_Curve curve = &curve_secp256k1;
+    wordcount_t num_words = num_words_secp256k1;
+    /* 1 * base ... 16 * base */
+    uECC_word_t points[FIXED_BASE_POINTS + 1][num_words_secp256k1 * 2];
+    int i, j;
+
+    uECC_vli_set(points[FIXED_BASE_POINTS], curve->G, num_words * 2);
+    for (i = 0; i < FIXED_BASE_WINDOWS; ++i) {
+        /* each window starts at 16 * base of the previous one */
+        EccPoint_multiples(points[0], points[FIXED_BASE_POINTS], FIXED_BASE_POINTS + 1, 1, curve);
+        for (j = 0; j < FIXED_BASE_POINTS; ++j) {
+            uECC_vli_set(g_fixed_base[i][j], points[j], num_words * 2);
+        }
+    }
+    g_fixed_base_ready = 1;
+}
+
+/* (rx, ry, z) = scalar * G in Jacobian coordinates. Partial sums never hit the doubling case:
+before window i the accumulator is below 16^i * G while the added point is at least 16^i * G
+(and below n). */
+static void EccPoint_mult_fixed_base_jacobian(uECC_word_t *rx,
+                                              uECC_word_t *ry,
+                                              uECC_word_t *z,
+                                              const uECC_word_t *scalar,
+                                              uECC_Curve curve) {
+    uECC_word_t t[uECC_MAX_WORDS * 2];
+    uECC_word_t infinity = (uECC_word_t)-1;
+    wordcount_t num_words = curve->num_words;
+    int i;
+
+    if (!g_fixed_base_ready) {
+        fixed_base_build();
+    }
+
+    uECC_vli_clear(rx, num_words);
+    uECC_vli_clear(ry, num_words);
+    uECC_vli_clear(z, num_words);
+    z[0] = 1;
+
+    for (i = 0; i < FIXED_BASE_WINDOWS; ++i) {
+        bitcount_t bit = (bitcount_t)i * 4;
+        uECC_word_t digit = (scalar[bit >> uECC_WORD_BITS_SHIFT] >>
+                             (bit & uECC_WORD_BITS_MASK)) & 0x0F;
+
+        EccPoint_lookup(t, g_fixed_base[i][0], FIXED_BASE_POINTS, digit, num_words);
+        EccPoint_add_masked(rx, ry, z, &infinity, t, -((digit + 0x0F) >> 4), curve);
+    }
+}
+
+/* result = scalar * G */
+static void EccPoint_mult_fixed_base(uECC_word_t *result,
+                                     const uECC_word_t *scalar,
+                                     uECC_Curve curve) {
+    uECC_word_t rx[uECC_MAX_WORDS];
+    uECC_word_t ry[uECC_MAX_WORDS];
+    uECC_word_t z[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+
+    EccPoint_mult_fixed_base_jacobian(rx, ry, z, scalar, curve);
+    uECC_vli_modInv(z, z, curve->p, num_words); /* Z = 1/Z */
+    apply_z(rx, ry, z, curve);
+    uECC_vli_set(result, rx, num_words);
+    uECC_vli_set(result + num_words, ry, num_words);
+}
+
+#endif /* uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_FIXED_BASE */
+
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV
+
+/* GLV endomorphism for secp256k1.
+lambda * (x, y) = (beta * x, y), so a scalar k can be split into k1 + k2 * lambda with k1 and k2
+at most 128 bits long, halving the number of doublings of a variable-base multiplication.
+The split uses the lattice basis (a1, b1), (a2, b2) from "Guide to Elliptic Curve Cryptography"
+(algorithm 3.74) and the rounding constants of libsecp256k1:
+g1 = round(2^384 * b2 / n), g2 = round(2^384 * -b1 / n). */
+#define GLV_BITS 130        /* |k1|, |k2| <= 2^128, plus a wNAF carry */
+#define GLV_WINDOWS 33      /* 4-bit windows covering GLV_BITS */
+#define GLV_POINTS 15       /* table size for the 4-bit windows */
+#define GLV_WINDOW_G 7      /* wNAF widths used for verification */
+#define GLV_WINDOW_Q 5
+#define GLV_POINTS_G (1 << (GLV_WINDOW_G - 2))
+#define GLV_POINTS_Q (1 << (GLV_WINDOW_Q - 2))
+
+static const uECC_word_t glv_g1[num_words_secp256k1] = {
+    BYTES_TO_WORDS_8(31, B0, DB, 45, 9A, 20, 93, E8),
+    BYTES_TO_WORDS_8(7F, CA, E8, 71, 14, 8A, AA, 3D),
+    BYTES_TO_WORDS_8(15, EB, 84, 92, E4, 90, 6C, E8),
+    BYTES_TO_WORDS_8(CD, 6B, D4, A7, 21, D2, 86, 30) };
+static const uECC_word_t glv_g2[num_words_secp256k1] = {
+    BYTES_TO_WORDS_8(71, 7F, C4, 8A, AE, B4, 71, 15),
+    BYTES_TO_WORDS_8(C6, 06, F5, 9D, AC, 08, 12, 22),
+    BYTES_TO_WORDS_8(C4, E4, BF, 0A, A9, 7F, 54, 6F),
+    BYTES_TO_WORDS_8(28, 88, 0E, 01, D6, 7E, 43, E4) };
+/* a1 = b2 */
+static const uECC_word_t glv_a1[num_words_secp256k1] = {
+    BYTES_TO_WORDS_8(15, EB, 84, 92, E4, 90, 6C, E8),
+    BYTES_TO_WORDS_8(CD, 6B, D4, A7, 21, D2, 86, 30),
+    BYTES_TO_WORDS_8(00, 00, 00, 00, 00, 00, 00, 00),
+    BYTES_TO_WORDS_8(00, 00, 00, 00, 00, 00, 00, 00) };
+static const uECC_word_t glv_a2[num_words_secp256k1] = {
+    BYTES_TO_WORDS_8(D8, CF, 44, 9D, 8D, 10, C1, 57),
+    BYTES_TO_WORDS_8(F6, F3, E2, A8, F7, 50, CA, 14),
+    BYTES_TO_WORDS_8(01, 00, 00, 00, 00, 00, 00, 00),
+    BYTES_TO_WORDS_8(00, 00, 00, 00, 00, 00, 00, 00) };
+static const uECC_word_t glv_minus_b1[num_words_secp256k1] = {
+    BYTES_TO_WORDS_8(C3, E4, BF, 0A, A9, 7F, 54, 6F),
+    BYTES_TO_WORDS_8(28, 88, 0E, 01, D6, 7E, 43, E4),
+    BYTES_TO_WORDS_8(00, 00, 00, 00, 00, 00, 00, 00),
+    BYTES_TO_WORDS_8(00, 00, 00, 00, 00, 00, 00, 00) };
+static const uECC_word_t glv_beta[num_words_secp256k1] = {
+    BYTES_TO_WORDS_8(EE, 01, 95, 71, 28, 6C, 39, C1),
+    BYTES_TO_WORDS_8(95, 89, F5, 12, 75, 49, F0, 9C),
+    BYTES_TO_WORDS_8(E9, 34, 34, AC, 9E, 47, 64, 6E),
+    BYTES_TO_WORDS_8(10, 07, 7C, 65, 2B, 6A, E9, 7A) };
+/* 2^256 - n */
+static const uECC_word_t glv_n_complement[num_words_secp256k1] = {
+    BYTES_TO_WORDS_8(BF, BE, C9, 2F, 73, A1, 2D, 40),
+    BYTES_TO_WORDS_8(C4, 5F, B7, 50, 19, 23, 51, 45),
+    BYTES_TO_WORDS_8(01, 00, 00, 00, 00, 00, 00, 00),
+    BYTES_TO_WORDS_8(00, 00, 00, 00, 00, 00, 00, 00) };
+
+/* odd multiples of G for verification, built on first use */
+static uECC_word_t g_glv_G[GLV_POINTS_G][num_words_secp256k1 * 2];
+static volatile uint8_t g_glv_G_ready = 0;
+
+/* c = round(k * g / 2^384) */
+static void glv_mul_shift(uECC_word_t *c,
+                          const uECC_word_t *k,
+                          const uECC_word_t *g,
+                          wordcount_t num_words) {
+    uECC_word_t product[uECC_MAX_WORDS * 2];
+    wordcount_t shift = 384 / uECC_WORD_BITS;
+    uECC_word_t round;
+
+    uECC_vli_mult(product, k, g, num_words);
+    round = (product[383 >> uECC_WORD_BITS_SHIFT] >> (383 & uECC_WORD_BITS_MASK)) & 1;
+    uECC_vli_clear(c, num_words);
+    uECC_vli_set(c, product + shift, num_words * 2 - shift);
+    uECC_vli_clear(product, num_words);
+    product[0] = round;
+    uECC_vli_add(c, c, product, num_words);
+}
+
+/* result = |value|, where value is a two's complement number of num_words * 2 words whose
+magnitude fits in num_words. Returns an all ones mask if value was negative. */
+static uECC_word_t glv_abs(uECC_word_t *result, uECC_word_t *value, wordcount_t num_words) {
+    uECC_word_t negated[uECC_MAX_WORDS * 2];
+    uECC_word_t neg = -(value[num_words * 2 - 1] >> (uECC_WORD_BITS - 1));
+
+    uECC_vli_clear(negated, num_words * 2);
+    uECC_vli_sub(negated, negated, value, num_words * 2);
+    vli_cmov(value, negated, neg, num_words * 2);
+    uECC_vli_set(result, value, num_words);
+    return neg;
+}
+
+/* Splits k into k1 + k2 * lambda (mod n) with plain integer arithmetic:
+k1 = k - c1 * a1 - c2 * a2, k2 = -c1 * b1 - c2 * b2. k1 and k2 are returned as magnitudes,
+neg1 and neg2 are all ones masks where the corresponding part is negative. */
+static void glv_split(uECC_word_t *k1,
+                      uECC_word_t *k2,
+                      uECC_word_t *neg1,
+                      uECC_word_t *neg2,
+                      const uECC_word_t *k,
+                      uECC_Curve curve) {
+    uECC_word_t c1[uECC_MAX_WORDS];
+    uECC_word_t c2[uECC_MAX_WORDS];
+    uECC_word_t p1[uECC_MAX_WORDS * 2];
+    uECC_word_t p2[uECC_MAX_WORDS * 2];
+    uECC_word_t t[uECC_MAX_WORDS * 2];
+    wordcount_t num_words = curve->num_words;
+
+    glv_mul_shift(c1, k, glv_g1, num_words);
+    glv_mul_shift(c2, k, glv_g2, num_words);
+
+    uECC_vli_mult(p1, c1, glv_a1, num_words);
+    uECC_vli_mult(p2, c2, glv_a2, num_words);
+    uECC_vli_add(p1, p1, p2, num_words * 2);
+    uECC_vli_clear(t, num_words * 2);
+    uECC_vli_set(t, k, num_words);
+    uECC_vli_sub(t, t, p1, num_words * 2);
+    *neg1 = glv_abs(k1, t, num_words);
+
+    uECC_vli_mult(p1, c1, glv_minus_b1, num_words);
+    uECC_vli_mult(p2, c2, glv_a1, num_words);
+    uECC_vli_sub(t, p1, p2, num_words * 2);
+    *neg2 = glv_abs(k2, t, num_words);
+}
+
+/* result = scalar * point using the endomorphism and 4-bit windows on both halves.
+Like EccPoint_mult() it runs the same operations for every scalar.
+The accumulator can only hit the doubling case for specially crafted scalars; a random
+private key does so with negligible probability. */
+static void EccPoint_mult_glv(uECC_word_t *result,
+                              const uECC_word_t *point,
+                              const uECC_word_t *scalar,
+                              uECC_Curve curve) {
+    uECC_word_t k[2][uECC_MAX_WORDS];
+    uECC_word_t neg[2];
+    uECC_word_t table[2][GLV_POINTS][uECC_MAX_WORDS * 2];
+    uECC_word_t rx[uECC_MAX_WORDS];
+    uECC_word_t ry[uECC_MAX_WORDS];
+    uECC_word_t z[uECC_MAX_WORDS];
+    uECC_word_t t[uECC_MAX_WORDS * 2];
+    uECC_word_t infinity = (uECC_word_t)-1;
+    wordcount_t num_words = curve->num_words;
+    int i, j, c;
+
+    glv_split(k[0], k[1], &neg[0], &neg[1], scalar, curve);
+
+    /* table[0] = multiples of +-point, table[1] = multiples of +-lambda * point */
+    EccPoint_multiples(table[0][0], point, GLV_POINTS, 1, curve);
+    for (j = 0; j < GLV_POINTS; ++j) {
+        uECC_vli_modMult_fast(table[1][j], table[0][j], glv_beta, curve);
+        uECC_vli_sub(t, curve->p, table[0][j] + num_words, num_words);
+        uECC_vli_set(table[1][j] + num_words, table[0][j] + num_words, num_words);
+        vli_cmov(table[0][j] + num_words, t, neg[0], num_words);
+        vli_cmov(table[1][j] + num_words, t, neg[1], num_words);
+    }
+
+    uECC_vli_clear(rx, num_words);
+    uECC_vli_clear(ry, num_words);
+    uECC_vli_clear(z, num_words);
+    z[0] = 1;
+
+    for (i = GLV_WINDOWS - 1; i >= 0; --i) {
+        bitcount_t bit = (bitcount_t)i * 4;
+        for (j = 0; j < 4; ++j) {
+            curve->double_jacobian(rx, ry, z, curve);
+        }
+        for (c = 0; c < 2; ++c) {
+            uECC_word_t digit = (k[c][bit >> uECC_WORD_BITS_SHIFT] >>
+                                 (bit & uECC_WORD_BITS_MASK)) & 0x0F;
+            EccPoint_lookup(t, table[c][0], GLV_POINTS, digit, num_words);
+            EccPoint_add_masked(rx, ry, z, &infinity, t, -((digit + 0x0F) >> 4), curve);
+        }
+    }
+
+    uECC_vli_modInv(z, z, curve->p, num_words); /* Z = 1/Z */
+    apply_z(rx, ry, z, curve);
+    uECC_vli_clear(t, num_words);
+    vli_cmov(rx, t, infinity, num_words);
+    vli_cmov(ry, t, infinity, num_words);
+    uECC_vli_set(result, rx, num_words);
+    uECC_vli_set(result + num_words, ry, num_words);
+}
+
+/* Writes k < 2^(GLV_BITS - 1) in width-w NAF: every digit is zero or odd and below 2^(w-1)
+in absolute value, and of any w consecutive digits at most one is nonzero.
+Returns the number of digits. */
+static int glv_wnaf(signed char *wnaf, const uECC_word_t *k, int w) {
+    int bit = 0;
+    int len = 0;
+    int carry = 0;
+    int j;
+
+    for (j = 0; j < GLV_BITS; ++j) {
+        wnaf[j] = 0;
+    }
+    while (bit < GLV_BITS) {
+        int now;
+        int digit;
+        if ((int)(!!uECC_vli_testBit(k, bit)) == carry) {
+            ++bit;
+            continue;
+        }
+        now = w;
+        if (now > GLV_BITS - bit) {
+            now = GLV_BITS - bit;
+        }
+        digit = carry;
+        for (j = 0; j < now; ++j) {
+            digit += (!!uECC_vli_testBit(k, bit + j)) << j;
+        }
+        carry = (digit >> (w - 1)) & 1;
+        digit -= carry << w;
+        wnaf[bit] = (signed char)digit;
+        len = bit + 1;
+        bit += now;
+    }
+    return len;
+}
+
+/* (rx, ry, z) += (x, y), handling the point at infinity and doubling. Variable time. */
+static void EccPoint_add_affine(uECC_word_t *rx,
+                                uECC_word_t *ry,
+                                uECC_word_t *z,
+                                uECC_word_t *infinity,
+                                const uECC_word_t *x,
+                                const uECC_word_t *y,
+                                uECC_Curve curve) {
+    uECC_word_t tx[uECC_MAX_WORDS];
+    uECC_word_t ty[uECC_MAX_WORDS];
+    uECC_word_t tz[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+
+    if (*infinity) {
+        uECC_vli_set(rx, x, num_words);
+        uECC_vli_set(ry, y, num_words);
+        uECC_vli_clear(z, num_words);
+        z[0] = 1;
+        *infinity = 0;
+        return;
+    }
+    uECC_vli_set(tx, x, num_words);
+    uECC_vli_set(ty, y, num_words);
+    apply_z(tx, ty, z, curve);
+    if (uECC_vli_equal(tx, rx, num_words)) {
+        if (uECC_vli_equal(ty, ry, num_words)) {
+            curve->double_jacobian(rx, ry, z, curve);
+        } else {
+            *infinity = 1;
+        }
+        return;
+    }
+    uECC_vli_modSub(tz, rx, tx, curve->p, num_words); /* Z = x2 - x1 */
+    XYcZ_add(tx, ty, rx, ry, curve);
+    uECC_vli_modMult_fast(z, z, tz, curve);
+}
+
+/* Checks that the x coordinate of u1 * G + u2 * Q is r modulo n, where table holds the
+GLV_POINTS_Q odd multiples of Q in affine coordinates. All four halves of the split scalars
+share one doubling chain of about 128 steps, and the result is compared in Jacobian
+coordinates to save the final inversion. Variable time, for public inputs only. */
+static int EccPoint_verify_glv(const uECC_word_t *r,
+                               const uECC_word_t *u1,
+                               const uECC_word_t *u2,
+                               const uECC_word_t *table,
+                               uECC_Curve curve) {
+    uECC_word_t k[4][uECC_MAX_WORDS];
+    uECC_word_t neg[4];
+    signed char wnaf[4][GLV_BITS];
+    const uECC_word_t *tables[4];
+    uECC_word_t rx[uECC_MAX_WORDS];
+    uECC_word_t ry[uECC_MAX_WORDS];
+    uECC_word_t z[uECC_MAX_WORDS];
+    uECC_word_t tx[uECC_MAX_WORDS];
+    uECC_word_t ty[uECC_MAX_WORDS];
+    uECC_word_t infinity = 1;
+    wordcount_t num_words = curve->num_words;
+    int len = 0;
+    int i, c;
+
+    if (!g_glv_G_ready) {
+        EccPoint_multiples(g_glv_G[0], curve->G, GLV_POINTS_G, 2, curve);
+        g_glv_G_ready = 1;
+    }
+    tables[0] = g_glv_G[0];
+    tables[1] = g_glv_G[0];
+    tables[2] = table;
+    tables[3] = table;
+
+    glv_split(k[0], k[1], &neg[0], &neg[1], u1, curve);
+    glv_split(k[2], k[3], &neg[2], &neg[3], u2, curve);
+    for (c = 0; c < 4; ++c) {
+        int l = glv_wnaf(wnaf[c], k[c], c < 2 ? GLV_WINDOW_G : GLV_WINDOW_Q);
+        if (l > len) {
+            len = l;
+        }
+    }
+
+    for (i = len - 1; i >= 0; --i) {
+        if (!infinity) {
+            curve->double_jacobian(rx, ry, z, curve);
+        }
+        for (c = 0; c < 4; ++c) {
+            int digit = wnaf[c][i];
+            const uECC_word_t *point;
+            if (digit == 0) {
+                continue;
+            }
+            point = tables[c] + ((digit < 0 ? -digit : digit) >> 1) * 2 * num_words;
+            if (c & 1) {
+                uECC_vli_modMult_fast(tx, point, glv_beta, curve); /* lambda * point */
+            } else {
+                uECC_vli_set(tx, point, num_words);
+            }
+            if ((digit < 0) != (neg[c] != 0)) {
+                uECC_vli_sub(ty, curve->p, point + num_words, num_words);
+            } else {
+                uECC_vli_set(ty, point + num_words, num_words);
+            }
+            EccPoint_add_affine(rx, ry, z, &infinity, tx, ty, curve);
+        }
+    }
+
+    if (infinity) {
+        return 0;
+    }
+
+    /* x = rx / z^2 must be r or, if r + n < p, r + n */
+    uECC_vli_modSquare_fast(z, z, curve);
+    uECC_vli_modMult_fast(tx, r, z, curve);
+    if (uECC_vli_equal(tx, rx, num_words)) {
+        return 1;
+    }
+    if (uECC_vli_add(ty, r, curve->n, num_words) || uECC_vli_cmp_unsafe(curve->p, ty, num_words) != 1) {
+        return 0;
+    }
+    uECC_vli_modMult_fast(tx, ty, z, curve);
+    return (int)(uECC_vli_equal(tx, rx, num_words));
+}
+
+/* result = (left * right) mod n. The high half of the product is folded back with
+2^256 = 2^256 - n (mod n) until it is gone, which is much faster than uECC_vli_mmod().
+Variable time, for public inputs only. */
+static void glv_modMult_n(uECC_word_t *result,
+                          const uECC_word_t *left,
+                          const uECC_word_t *right,
+                          uECC_Curve curve) {
+    uECC_word_t product[uECC_MAX_WORDS * 2];
+    uECC_word_t t[uECC_MAX_WORDS * 2];
+    wordcount_t num_words = curve->num_words;
+
+    uECC_vli_mult(product, left, right, num_words);
+    while (!uECC_vli_isZero(product + num_words, num_words)) {
+        uECC_vli_mult(t, product + num_words, glv_n_complement, num_words);
+        uECC_vli_clear(product + num_words, num_words);
+        uECC_vli_add(product, product, t, num_words * 2);
+    }
+    while (uECC_vli_cmp_unsafe(curve->n, product, num_words) != 1) {
+        uECC_vli_sub(product, product, curve->n, num_words);
+    }
+    uECC_vli_set(result, product, num_words);
+}
+
+/* Replaces each of values[0..count) with its inverse mod p, or mod n if mod_n is set, using
+a single inversion (Montgomery's trick). The values must be nonzero; prod is scratch space
+of count rows. */
+static void glv_batch_invert(uECC_word_t (*values)[uECC_MAX_WORDS],
+                             uECC_word_t (*prod)[uECC_MAX_WORDS],
+                             int count,
+                             int mod_n,
+                             uECC_Curve curve) {
+    uECC_word_t inv[uECC_MAX_WORDS];
+    uECC_word_t t[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    int i;
+
+    if (count == 0) {
+        return;
+    }
+    uECC_vli_set(prod[0], values[0], num_words);
+    for (i = 1; i < count; ++i) {
+        if (mod_n) {
+            glv_modMult_n(prod[i], prod[i - 1], values[i], curve);
+        } else {
+            uECC_vli_modMult_fast(prod[i], prod[i - 1], values[i], curve);
+        }
+    }
+    uECC_vli_modInv(inv, prod[count - 1], mod_n ? curve->n : curve->p, num_words);
+    for (i = count - 1; i > 0; --i) {
+        if (mod_n) {
+            glv_modMult_n(t, inv, prod[i - 1], curve);            /* 1 / values[i] */
+            glv_modMult_n(inv, inv, values[i], curve);
+        } else {
+            uECC_vli_modMult_fast(t, inv, prod[i - 1], curve);
+            uECC_vli_modMult_fast(inv, inv, values[i], curve);
+        }
+        uECC_vli_set(values[i], t, num_words);
+    }
+    uECC_vli_set(values[0], inv, num_words);
+}
+
+#endif /* uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV */
+
+/* result = scalar * G */
+static void EccPoint_mult_base(uECC_word_t *result,
+                               const uECC_word_t *scalar,
+                               uECC_Curve curve) {
     uECC_word_t tmp1[uECC_MAX_WORDS];
     uECC_word_t tmp2[uECC_MAX_WORDS];
     uECC_word_t *p2[2] = {tmp1, tmp2};
     uECC_word_t carry;
 
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_FIXED_BASE
+    if (curve == &curve_secp256k1) {
+        EccPoint_mult_fixed_base(result, scalar, curve);
+        return;
+    }
+#endif
+
     /* Regularize the bitcount for the private key so that attackers cannot use a side channel
        attack to learn the number of leading zeros. */
-    carry = regularize_k(private_key, tmp1, tmp2, curve);
+    carry = regularize_k(scalar, tmp1, tmp2, curve);
 
     EccPoint_mult(result, curve->G, p2[!carry], 0, curve->num_n_bits + 1, curve);
+}
+
+static uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
+                                               uECC_word_t *private_key,
+                                               uECC_Curve curve) {
+    EccPoint_mult_base(result, private_key, curve);
 
     if (EccPoint_isZero(result, curve)) {
         return 0;
@@ -1055,20 +1770,27 @@ int uECC_shared_secret(const uint8_t *public_key,
     uECC_vli_bytesToNative(_public + num_words, public_key + num_bytes, num_bytes);
 #endif
 
-    /* Regularize the bitcount for the private key so that attackers cannot use a side channel
-       attack to learn the number of leading zeros. */
-    carry = regularize_k(_private, _private, tmp, curve);
-
-    /* If an RNG function was specified, try to get a random initial Z value to improve
-       protection against side-channel attacks. */
-    if (g_rng_function) {
-        if (!uECC_generate_random_int(p2[carry], curve->p, num_words)) {
-            return 0;
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV
+    if (curve == &curve_secp256k1) {
+        EccPoint_mult_glv(_public, _public, _private, curve);
+    } else
+#endif
+    {
+        /* Regularize the bitcount for the private key so that attackers cannot use a side channel
+           attack to learn the number of leading zeros. */
+        carry = regularize_k(_private, _private, tmp, curve);
+
+        /* If an RNG function was specified, try to get a random initial Z value to improve
+           protection against side-channel attacks. */
+        if (g_rng_function) {
+            if (!uECC_generate_random_int(p2[carry], curve->p, num_words)) {
+                return 0;
+            }
+            initial_Z = p2[carry];
         }
-        initial_Z = p2[carry];
-    }
 
-    EccPoint_mult(_public, _public, p2[!carry], initial_Z, curve->num_n_bits + 1, curve);
+        EccPoint_mult(_public, _public, p2[!carry], initial_Z, curve->num_n_bits + 1, curve);
+    }
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN
     bcopy((uint8_t *) secret, (uint8_t *) _public, num_bytes);
 #else
@@ -1242,24 +1964,20 @@ int uECC_sign_with_k(const uint8_t *private_key,
     uECC_word_t tmp[uECC_MAX_WORDS];
     uECC_word_t s[uECC_MAX_WORDS];
     uECC_word_t s2[uECC_MAX_WORDS]; // n-s
-    uECC_word_t *k2[2] = {tmp, s};
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN
     uECC_word_t *p = (uECC_word_t *)signature;
 #else
     uECC_word_t p[uECC_MAX_WORDS * 2];
 #endif
-    uECC_word_t carry;
     wordcount_t num_words = curve->num_words;
     wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
-    bitcount_t num_n_bits = curve->num_n_bits;
 
     /* Make sure 0 < k < curve_n */
     if (uECC_vli_isZero(k, num_words) || uECC_vli_cmp(curve->n, k, num_n_words) != 1) {
         return 0;
     }
 
-    carry = regularize_k(k, tmp, s, curve);
-    EccPoint_mult(p, curve->G, k2[!carry], 0, num_n_bits + 1, curve);
+    EccPoint_mult_base(p, (uECC_word_t *)k, curve);
     if (uECC_vli_isZero(p, num_words)) {
         return 0;
     }
@@ -1509,6 +2227,155 @@ int uECC_add_points(const uint8_t *p1, const uint8_t *p2, uint8_t *p3, uECC_Curv
     return 0;
 }
 
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_FIXED_BASE
+
+#define TWEAK_BATCH 16
+
+/* results[i] = tweaks[i] * G + point for up to TWEAK_BATCH tweaks. The sums are kept in Jacobian
+coordinates and converted to affine with one shared inversion (Montgomery's trick). */
+static unsigned tweak_add_batch_fixed_base(const uECC_word_t *point,
+                                           const uint8_t *tweaks,
+                                           unsigned num,
+                                           uint8_t *results,
+                                           uECC_Curve curve) {
+    uECC_word_t X[TWEAK_BATCH][uECC_MAX_WORDS];
+    uECC_word_t Y[TWEAK_BATCH][uECC_MAX_WORDS];
+    uECC_word_t Z[TWEAK_BATCH][uECC_MAX_WORDS];
+    uECC_word_t prod[TWEAK_BATCH][uECC_MAX_WORDS];
+    uECC_word_t k[uECC_MAX_WORDS];
+    uECC_word_t px[uECC_MAX_WORDS];
+    uECC_word_t py[uECC_MAX_WORDS];
+    uECC_word_t tz[uECC_MAX_WORDS];
+    uECC_word_t inv[uECC_MAX_WORDS];
+    uint8_t ok[TWEAK_BATCH];
+    unsigned valid = 0;
+    unsigned i;
+    wordcount_t j;
+    wordcount_t num_words = curve->num_words;
+
+    for (i = 0; i < num; ++i) {
+        /* invalid entries keep Z = 1 so that they don't break the shared inversion */
+        ok[i] = 0;
+        uECC_vli_clear(X[i], num_words);
+        uECC_vli_clear(Y[i], num_words);
+        uECC_vli_clear(Z[i], num_words);
+        Z[i][0] = 1;
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+        bcopy((uint8_t *) k, tweaks + i * curve->num_bytes, curve->num_bytes);
+#else
+        uECC_vli_bytesToNative(k, tweaks + i * curve->num_bytes, curve->num_bytes);
+#endif
+        /* the tweak must be in [1, n - 1] */
+        if (uECC_vli_isZero(k, num_words) || uECC_vli_cmp_unsafe(curve->n, k, num_words) != 1) {
+            continue;
+        }
+        EccPoint_mult_fixed_base_jacobian(X[i], Y[i], Z[i], k, curve);
+
+        /* bring point to the same Z and add it with a co-Z addition */
+        uECC_vli_set(px, point, num_words);
+        uECC_vli_set(py, point + num_words, num_words);
+        apply_z(px, py, Z[i], curve);
+        uECC_vli_modSub(tz, X[i], px, curve->p, num_words); /* Z = x2 - x1 */
+        if (uECC_vli_isZero(tz, num_words)) {
+            if (!uECC_vli_equal(Y[i], py, num_words)) {
+                /* tweak * G == -point, the sum is the point at infinity */
+                uECC_vli_clear(Z[i], num_words);
+                Z[i][0] = 1;
+                continue;
+            }
+            curve->double_jacobian(X[i], Y[i], Z[i], curve);
+        } else {
+            XYcZ_add(px, py, X[i], Y[i], curve);
+            uECC_vli_modMult_fast(Z[i], Z[i], tz, curve);
+        }
+        ok[i] = 1;
+    }
+
+    uECC_vli_set(prod[0], Z[0], num_words);
+    for (i = 1; i < num; ++i) {
+        uECC_vli_modMult_fast(prod[i], prod[i - 1], Z[i], curve);
+    }
+    uECC_vli_modInv(inv, prod[num - 1], curve->p, num_words);
+
+    for (i = num; i-- > 0; ) {
+        if (i > 0) {
+            uECC_vli_modMult_fast(tz, inv, prod[i - 1], curve); /* 1 / Z[i] */
+            uECC_vli_modMult_fast(inv, inv, Z[i], curve);
+        } else {
+            uECC_vli_set(tz, inv, num_words);
+        }
+        apply_z(X[i], Y[i], tz, curve);
+    }
+
+    for (i = 0; i < num; ++i) {
+        uint8_t *result = results + i * curve->num_bytes * 2;
+        if (!ok[i]) {
+            for (j = 0; j < curve->num_bytes * 2; ++j) {
+                result[j] = 0;
+            }
+            continue;
+        }
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+        bcopy(result, (uint8_t *) X[i], curve->num_bytes);
+        bcopy(result + curve->num_bytes, (uint8_t *) Y[i], curve->num_bytes);
+#else
+        uECC_vli_nativeToBytes(result, curve->num_bytes, X[i]);
+        uECC_vli_nativeToBytes(result + curve->num_bytes, curve->num_bytes, Y[i]);
+#endif
+        ++valid;
+    }
+    return valid;
+}
+
+#endif /* uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_FIXED_BASE */
+
+int uECC_tweak_add_batch(const uint8_t *point,
+                         const uint8_t *tweaks,
+                         unsigned num,
+                         uint8_t *results,
+                         uECC_Curve curve) {
+    unsigned valid = 0;
+    unsigned i;
+    wordcount_t j;
+
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_FIXED_BASE
+    if (curve == &curve_secp256k1) {
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+        uECC_word_t *_point = (uECC_word_t *)point;
+#else
+        uECC_word_t _point[uECC_MAX_WORDS * 2];
+        uECC_vli_bytesToNative(_point, point, curve->num_bytes);
+        uECC_vli_bytesToNative(_point + curve->num_words, point + curve->num_bytes, curve->num_bytes);
+#endif
+        for (i = 0; i < num; i += TWEAK_BATCH) {
+            unsigned n = (num - i < TWEAK_BATCH) ? num - i : TWEAK_BATCH;
+            valid += tweak_add_batch_fixed_base(_point,
+                                                tweaks + i * curve->num_bytes,
+                                                n,
+                                                results + i * curve->num_bytes * 2,
+                                                curve);
+        }
+        return (int)valid;
+    }
+#endif
+
+    for (i = 0; i < num; ++i) {
+        uint8_t *result = results + i * curve->num_bytes * 2;
+        uint8_t tweak_point[uECC_MAX_WORDS * uECC_WORD_SIZE * 2];
+
+        if (!uECC_compute_public_key(tweaks + i * curve->num_bytes, tweak_point, curve)) {
+            for (j = 0; j < curve->num_bytes * 2; ++j) {
+                result[j] = 0;
+            }
+            continue;
+        }
+        uECC_add_points(tweak_point, point, result, curve);
+        ++valid;
+    }
+    return (int)valid;
+}
+
 int uECC_verify(const uint8_t *public_key,
                 const uint8_t *message_hash,
                 unsigned hash_size,
@@ -1568,6 +2435,14 @@ int uECC_verify(const uint8_t *public_key,
     uECC_vli_modMult(u1, u1, z, curve->n, num_n_words); /* u1 = e/s */
     uECC_vli_modMult(u2, r, z, curve->n, num_n_words); /* u2 = r/s */
 
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV
+    if (curve == &curve_secp256k1) {
+        uECC_word_t table[GLV_POINTS_Q][uECC_MAX_WORDS * 2];
+        EccPoint_multiples(table[0], _public, GLV_POINTS_Q, 2, curve);
+        return EccPoint_verify_glv(r, u1, u2, table[0], curve);
+    }
+#endif
+
     /* Calculate sum = G + Q. */
     uECC_vli_set(sum, _public, num_words);
     uECC_vli_set(sum + num_words, _public + num_words, num_words);
@@ -1621,6 +2496,127 @@ int uECC_verify(const uint8_t *public_key,
     return (int)(uECC_vli_equal(rx, r, num_words));
 }
 
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV
+
+#define VERIFY_BATCH 16
+
+/* Verifies up to VERIFY_BATCH secp256k1 signatures. The inversions of s (mod n) and of the
+Q table chains (mod p) are shared between all entries of the batch. */
+static unsigned verify_batch_glv(const uint8_t *public_keys,
+                                 const uint8_t *message_hashes,
+                                 unsigned hash_size,
+                                 const uint8_t *signatures,
+                                 unsigned num,
+                                 uint8_t *results,
+                                 uECC_Curve curve) {
+    uECC_word_t X[VERIFY_BATCH][GLV_POINTS_Q][uECC_MAX_WORDS];
+    uECC_word_t Y[VERIFY_BATCH][GLV_POINTS_Q][uECC_MAX_WORDS];
+    uECC_word_t Z[VERIFY_BATCH][GLV_POINTS_Q][uECC_MAX_WORDS];
+    uECC_word_t prod[VERIFY_BATCH][GLV_POINTS_Q][uECC_MAX_WORDS];
+    uECC_word_t r[VERIFY_BATCH][uECC_MAX_WORDS];
+    uECC_word_t s[VERIFY_BATCH][uECC_MAX_WORDS];
+    uECC_word_t zinv[VERIFY_BATCH][uECC_MAX_WORDS];
+    uECC_word_t scratch[VERIFY_BATCH][uECC_MAX_WORDS];
+    uECC_word_t table[GLV_POINTS_Q][uECC_MAX_WORDS * 2];
+    uECC_word_t _public[uECC_MAX_WORDS * 2];
+    uECC_word_t u1[uECC_MAX_WORDS], u2[uECC_MAX_WORDS];
+    unsigned index[VERIFY_BATCH];
+    unsigned valid = 0;
+    unsigned i;
+    int count = 0;
+    int c;
+    wordcount_t num_words = curve->num_words;
+
+    for (i = 0; i < num; ++i) {
+        const uint8_t *public_key = public_keys + i * curve->num_bytes * 2;
+        const uint8_t *signature = signatures + i * curve->num_bytes * 2;
+
+        results[i] = 0;
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+        bcopy((uint8_t *) _public, public_key, curve->num_bytes * 2);
+        bcopy((uint8_t *) r[count], signature, curve->num_bytes);
+        bcopy((uint8_t *) s[count], signature + curve->num_bytes, curve->num_bytes);
+#else
+        uECC_vli_bytesToNative(_public, public_key, curve->num_bytes);
+        uECC_vli_bytesToNative(
+            _public + num_words, public_key + curve->num_bytes, curve->num_bytes);
+        uECC_vli_bytesToNative(r[count], signature, curve->num_bytes);
+        uECC_vli_bytesToNative(s[count], signature + curve->num_bytes, curve->num_bytes);
+#endif
+
+        /* r, s must be in [1, n - 1]. */
+        if (uECC_vli_isZero(r[count], num_words) || uECC_vli_isZero(s[count], num_words) ||
+                uECC_vli_cmp_unsafe(curve->n, r[count], num_words) != 1 ||
+                uECC_vli_cmp_unsafe(curve->n, s[count], num_words) != 1) {
+            continue;
+        }
+
+        EccPoint_chain(X[count], Y[count], Z[count], prod[count], _public, GLV_POINTS_Q, 2, curve);
+        /* an invalid public key can collapse the chain; keep it out of the shared inversion */
+        if (uECC_vli_isZero(prod[count][GLV_POINTS_Q - 1], num_words)) {
+            continue;
+        }
+        uECC_vli_set(zinv[count], prod[count][GLV_POINTS_Q - 1], num_words);
+        index[count] = i;
+        ++count;
+    }
+
+    glv_batch_invert(s, scratch, count, 1, curve);
+    glv_batch_invert(zinv, scratch, count, 0, curve);
+
+    for (c = 0; c < count; ++c) {
+        i = index[c];
+        EccPoint_chain_affine(table[0], X[c], Y[c], (const uECC_word_t (*)[uECC_MAX_WORDS])Z[c],
+                              (const uECC_word_t (*)[uECC_MAX_WORDS])prod[c], zinv[c],
+                              GLV_POINTS_Q, curve);
+        bits2int(u1, message_hashes + i * hash_size, hash_size, curve);
+        glv_modMult_n(u1, u1, s[c], curve); /* u1 = e/s */
+        glv_modMult_n(u2, r[c], s[c], curve); /* u2 = r/s */
+        results[i] = (uint8_t)EccPoint_verify_glv(r[c], u1, u2, table[0], curve);
+        valid += results[i];
+    }
+    return valid;
+}
+
+#endif /* uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV */
+
+int uECC_verify_batch(const uint8_t *public_keys,
+                      const uint8_t *message_hashes,
+                      unsigned hash_size,
+                      const uint8_t *signatures,
+                      unsigned num,
+                      uint8_t *results,
+                      uECC_Curve curve) {
+    unsigned valid = 0;
+    unsigned i;
+
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV
+    if (curve == &curve_secp256k1) {
+        for (i = 0; i < num; i += VERIFY_BATCH) {
+            unsigned n = (num - i < VERIFY_BATCH) ? num - i : VERIFY_BATCH;
+            valid += verify_batch_glv(public_keys + i * curve->num_bytes * 2,
+                                      message_hashes + i * hash_size,
+                                      hash_size,
+                                      signatures + i * curve->num_bytes * 2,
+                                      n,
+                                      results + i,
+                                      curve);
+        }
+        return (int)valid;
+    }
+#endif
+
+    for (i = 0; i < num; ++i) {
+        results[i] = (uint8_t)uECC_verify(public_keys + i * curve->num_bytes * 2,
+                                          message_hashes + i * hash_size,
+                                          hash_size,
+                                          signatures + i * curve->num_bytes * 2,
+                                          curve);
+        valid += results[i];
+    }
+    return (int)valid;
+}
+
 #if uECC_ENABLE_VLI_API
 
 unsigned uECC_curve_num_words(uECC_Curve curve) {
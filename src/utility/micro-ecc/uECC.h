@@ -75,6 +75,41 @@ the same endianness. */
     #define uECC_SUPPORT_COMPRESSED_POINT 1
 #endif
 
+/* uECC_SECP256K1_FIXED_BASE - If enabled (defined as nonzero), multiplications by the generator
+on secp256k1 (uECC_make_key(), uECC_compute_public_key() and signing) use a table of precomputed
+multiples of G instead of the Montgomery ladder. This is several times faster, but the table takes
+60 kB of RAM and is built on the first call, so it is only enabled by default on desktop platforms.
+Define it as 0 to opt out, or as 1 to enable it on a board with enough memory. */
+#ifndef uECC_SECP256K1_FIXED_BASE
+    #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86) || \
+        defined(__aarch64__)
+        #define uECC_SECP256K1_FIXED_BASE 1
+    #else
+        #define uECC_SECP256K1_FIXED_BASE 0
+    #endif
+#endif
+
+/* uECC_SECP256K1_GLV - If enabled (defined as nonzero), uECC_verify() and uECC_shared_secret() on
+secp256k1 use the curve's endomorphism to split scalars in two halves, roughly halving the number
+of point doublings. Verification also uses wNAF. This costs about 2 kB of stack and 1 kB of RAM,
+so like uECC_SECP256K1_FIXED_BASE it is only enabled by default on desktop platforms. */
+#ifndef uECC_SECP256K1_GLV
+    #define uECC_SECP256K1_GLV uECC_SECP256K1_FIXED_BASE
+#endif
+
+/* uECC_SECP256K1_INT128 - If enabled (defined as nonzero), secp256k1 field multiplication,
+squaring and inversion use a dedicated backend for 64-bit words built on unsigned __int128
+(secp256k1_int128.inc) instead of the generic loops. It requires uECC_WORD_SIZE 8 and compiler
+support for __int128, and is enabled by default on x86_64 and arm64. */
+#ifndef uECC_SECP256K1_INT128
+    #if (defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__)) && \
+        defined(__SIZEOF_INT128__)
+        #define uECC_SECP256K1_INT128 1
+    #else
+        #define uECC_SECP256K1_INT128 0
+    #endif
+#endif
+
 struct uECC_Curve_t;
 typedef const struct uECC_Curve_t * uECC_Curve;
 
@@ -362,6 +397,30 @@ Returns 1 if calcualted successfully, 0 if an error occurred
 */
 int uECC_add_points(const uint8_t *p1, const uint8_t *p2, uint8_t *p3, uECC_Curve curve);
 
+/* uECC_tweak_add_batch() function.
+Calculates tweak * G + point for several tweaks, as in BIP32 public key derivation.
+
+Usage: Like calling uECC_compute_public_key() and uECC_add_points() for each tweak, but on
+secp256k1 (with uECC_SECP256K1_FIXED_BASE) the sums stay in Jacobian coordinates and share one
+inversion for the conversion back to affine coordinates.
+
+Inputs:
+    point  - The point to add to.
+    tweaks - num scalars, one after another.
+    num    - The number of tweaks.
+
+Outputs:
+    results - Will be filled with num points, one after another. A result is set to zero if its
+              tweak is not in [1, n-1] or the sum is the point at infinity.
+
+Returns the number of valid results.
+*/
+int uECC_tweak_add_batch(const uint8_t *point,
+                         const uint8_t *tweaks,
+                         unsigned num,
+                         uint8_t *results,
+                         uECC_Curve curve);
+
 /* uECC_verify() function.
 Verify an ECDSA signature.
 
@@ -382,6 +441,33 @@ int uECC_verify(const uint8_t *public_key,
                 const uint8_t *signature,
                 uECC_Curve curve);
 
+/* uECC_verify_batch() function.
+Verify several ECDSA signatures at once.
+
+Usage: Like calling uECC_verify() for each entry, but on secp256k1 (with uECC_SECP256K1_GLV) the
+modular inversions are shared between entries, which makes verification of many signatures
+noticeably faster. Other curves fall back to uECC_verify().
+
+Inputs:
+    public_keys    - num public keys, one after another.
+    message_hashes - num hashes of hash_size bytes, one after another.
+    hash_size      - The size of each message hash in bytes.
+    signatures     - num signature values, one after another.
+    num            - The number of signatures to verify.
+
+Outputs:
+    results - Will be filled with 1 for each valid signature and 0 for each invalid one.
+
+Returns the number of valid signatures.
+*/
+int uECC_verify_batch(const uint8_t *public_keys,
+                      const uint8_t *message_hashes,
+                      unsigned hash_size,
+                      const uint8_t *signatures,
+                      unsigned num,
+                      uint8_t *results,
+                      uECC_Curve curve);
+
 #ifdef __cplusplus
 } /* end of extern "C" */
 #endif
@@ -24,14 +24,26 @@
 
 #include "segwit_addr.h"
 
+/* generator contributions of the 5 bits shifted out of the checksum */
+static const uint32_t bech32_polymod_table[32] = {
+    0x00000000UL, 0x3b6a57b2UL, 0x26508e6dUL, 0x1d3ad9dfUL,
+    0x1ea119faUL, 0x25cb4e48UL, 0x38f19797UL, 0x039bc025UL,
+    0x3d4233ddUL, 0x0628646fUL, 0x1b12bdb0UL, 0x2078ea02UL,
+    0x23e32a27UL, 0x18897d95UL, 0x05b3a44aUL, 0x3ed9f3f8UL,
+    0x2a1462b3UL, 0x117e3501UL, 0x0c44ecdeUL, 0x372ebb6cUL,
+    0x34b57b49UL, 0x0fdf2cfbUL, 0x12e5f524UL, 0x298fa296UL,
+    0x1756516eUL, 0x2c3c06dcUL, 0x3106df03UL, 0x0a6c88b1UL,
+    0x09f74894UL, 0x329d1f26UL, 0x2fa7c6f9UL, 0x14cd914bUL,
+};
+
 uint32_t bech32_polymod_step(uint32_t pre) {
-    uint8_t b = pre >> 25;
-    return ((pre & 0x1FFFFFF) << 5) ^
-        (-((b >> 0) & 1) & 0x3b6a57b2UL) ^
-        (-((b >> 1) & 1) & 0x26508e6dUL) ^
-        (-((b >> 2) & 1) & 0x1ea119faUL) ^
-        (-((b >> 3) & 1) & 0x3d4233ddUL) ^
-        (-((b >> 4) & 1) & 0x2a1462b3UL);
+    return ((pre & 0x1FFFFFF) << 5) ^ bech32_polymod_table[pre >> 25];
+}
+
+static uint32_t bech32_final_constant(bech32_encoding enc) {
+    if (enc == BECH32_ENCODING_BECH32) return 1;
+    if (enc == BECH32_ENCODING_BECH32M) return 0x2bc830a3;
+    return 0;
 }
 
 static const char* charset = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
@@ -47,8 +59,10 @@ static const int8_t charset_rev[128] = {
      1,  0,  3, 16, 11, 28, 12, 14,  6,  4,  2, -1, -1, -1, -1, -1
 };
 
-int bech32_encode(char *output, const char *hrp, const uint8_t *data, size_t data_len) {
-    uint32_t chk = 1;
+/* Checksum state after the expanded human readable part, shared by all
+ * strings with the same hrp. Returns 0 if hrp is invalid. */
+static int bech32_hrp_checksum(const char *hrp, size_t *hrp_len, uint32_t *chk) {
+    uint32_t c = 1;
     size_t i = 0;
     while (hrp[i] != 0) {
         int ch = hrp[i];
@@ -57,54 +71,69 @@ int bech32_encode(char *output, const char *hrp, const uint8_t *data, size_t dat
         }
 
         if (ch >= 'A' && ch <= 'Z') return 0;
-        chk = bech32_polymod_step(chk) ^ (ch >> 5);
+        c = bech32_polymod_step(c) ^ (ch >> 5);
         ++i;
     }
-    if (i + 7 + data_len > MAX_BECH32_SIZE) return 0;
-    chk = bech32_polymod_step(chk);
-    while (*hrp != 0) {
-        chk = bech32_polymod_step(chk) ^ (*hrp & 0x1f);
-        *(output++) = *(hrp++);
+    c = bech32_polymod_step(c);
+    for (*hrp_len = i, i = 0; i < *hrp_len; ++i) {
+        c = bech32_polymod_step(c) ^ (hrp[i] & 0x1f);
     }
+    *chk = c;
+    return 1;
+}
+
+/* Appends 6 checksum characters and the null terminator. */
+static void bech32_finish(char *output, uint32_t chk, bech32_encoding enc) {
+    size_t i;
+    for (i = 0; i < 6; ++i) {
+        chk = bech32_polymod_step(chk);
+    }
+    chk ^= bech32_final_constant(enc);
+    for (i = 0; i < 6; ++i) {
+        output[i] = charset[(chk >> ((5 - i) * 5)) & 0x1f];
+    }
+    output[6] = 0;
+}
+
+int bech32_encode(char *output, const char *hrp, const uint8_t *data, size_t data_len, bech32_encoding enc) {
+    uint32_t chk;
+    size_t i, hrp_len;
+    if (!bech32_hrp_checksum(hrp, &hrp_len, &chk)) return 0;
+    if (hrp_len + 7 + data_len > MAX_BECH32_SIZE) return 0;
+    memcpy(output, hrp, hrp_len);
+    output += hrp_len;
     *(output++) = '1';
     for (i = 0; i < data_len; ++i) {
         if (*data >> 5) return 0;
         chk = bech32_polymod_step(chk) ^ (*data);
         *(output++) = charset[*(data++)];
     }
-    for (i = 0; i < 6; ++i) {
-        chk = bech32_polymod_step(chk);
-    }
-    chk ^= 1;
-    for (i = 0; i < 6; ++i) {
-        *(output++) = charset[(chk >> ((5 - i) * 5)) & 0x1f];
-    }
-    *output = 0;
+    bech32_finish(output, chk, enc);
     return 1;
 }
 
-int bech32_decode(char* hrp, uint8_t *data, size_t *data_len, const char *input) {
+bech32_encoding bech32_decode(char* hrp, uint8_t *data, size_t *data_len, const char *input) {
     uint32_t chk = 1;
     size_t i;
     size_t input_len = strlen(input);
     size_t hrp_len;
     int have_lower = 0, have_upper = 0;
     if (input_len < 8 || input_len > MAX_BECH32_SIZE) {
-        return 0;
+        return BECH32_ENCODING_NONE;
     }
     *data_len = 0;
     while (*data_len < input_len && input[(input_len - 1) - *data_len] != '1') {
         ++(*data_len);
     }
     hrp_len = input_len - (1 + *data_len);
-    if (hrp_len < 1 || *data_len < 6) {
-        return 0;
+    if (1 + *data_len >= input_len || *data_len < 6) {
+        return BECH32_ENCODING_NONE;
     }
     *(data_len) -= 6;
     for (i = 0; i < hrp_len; ++i) {
         int ch = input[i];
         if (ch < 33 || ch > 126) {
-            return 0;
+            return BECH32_ENCODING_NONE;
         }
         if (ch >= 'a' && ch <= 'z') {
             have_lower = 1;
@@ -126,7 +155,7 @@ int bech32_decode(char* hrp, uint8_t *data, size_t *data_len, const char *input)
         if (input[i] >= 'a' && input[i] <= 'z') have_lower = 1;
         if (input[i] >= 'A' && input[i] <= 'Z') have_upper = 1;
         if (v == -1) {
-            return 0;
+            return BECH32_ENCODING_NONE;
         }
         chk = bech32_polymod_step(chk) ^ v;
         if (i + 6 < input_len) {
@@ -135,9 +164,14 @@ int bech32_decode(char* hrp, uint8_t *data, size_t *data_len, const char *input)
         ++i;
     }
     if (have_lower && have_upper) {
-        return 0;
+        return BECH32_ENCODING_NONE;
     }
-    return chk == 1;
+    if (chk == bech32_final_constant(BECH32_ENCODING_BECH32)) {
+        return BECH32_ENCODING_BECH32;
+    } else if (chk == bech32_final_constant(BECH32_ENCODING_BECH32M)) {
+        return BECH32_ENCODING_BECH32M;
+    }
+    return BECH32_ENCODING_NONE;
 }
 
 int convert_bits(uint8_t* out, size_t* outlen, int outbits, const uint8_t* in, size_t inlen, int inbits, int pad) {
@@ -162,30 +196,87 @@ int convert_bits(uint8_t* out, size_t* outlen, int outbits, const uint8_t* in, s
     return 1;
 }
 
-int segwit_addr_encode(char *output, const char *hrp, int witver, const uint8_t *witprog, size_t witprog_len) {
-    uint8_t data[65];
-    size_t datalen = 0;
-    if (witver > 16) return 0;
+static int segwit_addr_check(int witver, size_t witprog_len) {
+    if (witver < 0 || witver > 16) return 0;
     if (witver == 0 && witprog_len != 20 && witprog_len != 32) return 0;
     if (witprog_len < 2 || witprog_len > 40) return 0;
-    data[0] = witver;
-    convert_bits(data + 1, &datalen, 5, witprog, witprog_len, 8, 1);
-    ++datalen;
-    return bech32_encode(output, hrp, data, datalen);
+    return 1;
+}
+
+/* Writes the data part of an address with a known hrp checksum state,
+ * converting the program to 5-bit groups on the fly.
+ * Output already contains hrp and '1'. */
+static void segwit_addr_data(char *output, uint32_t chk, int witver, const uint8_t *witprog, size_t witprog_len) {
+    uint32_t val = 0;
+    int bits = 0;
+    size_t i;
+    chk = bech32_polymod_step(chk) ^ witver;
+    *(output++) = charset[witver];
+    for (i = 0; i < witprog_len; ++i) {
+        val = (val << 8) | witprog[i];
+        bits += 8;
+        while (bits >= 5) {
+            uint8_t v;
+            bits -= 5;
+            v = (val >> bits) & 0x1f;
+            chk = bech32_polymod_step(chk) ^ v;
+            *(output++) = charset[v];
+        }
+    }
+    if (bits) {
+        uint8_t v = (val << (5 - bits)) & 0x1f;
+        chk = bech32_polymod_step(chk) ^ v;
+        *(output++) = charset[v];
+    }
+    bech32_finish(output, chk, witver == 0 ? BECH32_ENCODING_BECH32 : BECH32_ENCODING_BECH32M);
+}
+
+int segwit_addr_encode(char *output, const char *hrp, int witver, const uint8_t *witprog, size_t witprog_len) {
+    uint32_t chk;
+    size_t hrp_len;
+    if (!segwit_addr_check(witver, witprog_len)) return 0;
+    if (!bech32_hrp_checksum(hrp, &hrp_len, &chk)) return 0;
+    if (hrp_len + 8 + (witprog_len * 8 + 4) / 5 > MAX_BECH32_SIZE) return 0;
+    memcpy(output, hrp, hrp_len);
+    output[hrp_len] = '1';
+    segwit_addr_data(output + hrp_len + 1, chk, witver, witprog, witprog_len);
+    return 1;
+}
+
+size_t segwit_addr_encode_many(char *output, size_t stride, const char *hrp, int witver, const uint8_t *witprogs, size_t witprog_len, size_t count) {
+    uint32_t chk;
+    size_t hrp_len, i;
+    if (!segwit_addr_check(witver, witprog_len)) return 0;
+    if (!bech32_hrp_checksum(hrp, &hrp_len, &chk)) return 0;
+    /* hrp, '1', version, program and checksum */
+    if (stride < hrp_len + 9 + (witprog_len * 8 + 4) / 5) return 0;
+    for (i = 0; i < count; ++i) {
+        char *address = output + i * stride;
+        memcpy(address, hrp, hrp_len);
+        address[hrp_len] = '1';
+        segwit_addr_data(address + hrp_len + 1, chk, witver, witprogs + i * witprog_len, witprog_len);
+    }
+    return count;
 }
 
 int segwit_addr_decode(int* witver, uint8_t* witdata, size_t* witdata_len, const char* hrp, const char* addr) {
     uint8_t data[84];
     char hrp_actual[84];
     size_t data_len;
-    if (!bech32_decode(hrp_actual, data, &data_len, addr)) return 0;
+    bech32_encoding enc;
+    /* addresses are limited to 90 characters, longer strings don't fit in data */
+    if (strlen(addr) > 90) return 0;
+    enc = bech32_decode(hrp_actual, data, &data_len, addr);
+    if (enc == BECH32_ENCODING_NONE) return 0;
     if (data_len == 0 || data_len > 65) return 0;
     if (strncmp(hrp, hrp_actual, 84) != 0) return 0;
     if (data[0] > 16) return 0;
+    if (data[0] == 0 && enc != BECH32_ENCODING_BECH32) return 0;
+    if (data[0] != 0 && enc != BECH32_ENCODING_BECH32M) return 0;
     *witdata_len = 0;
     if (!convert_bits(witdata, witdata_len, 8, data + 1, data_len - 1, 5, 0)) return 0;
     if (*witdata_len < 2 || *witdata_len > 40) return 0;
     if (data[0] == 0 && *witdata_len != 20 && *witdata_len != 32) return 0;
     *witver = data[0];
     return 1;
-}
\ No newline at end of file
+}
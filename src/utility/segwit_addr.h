@@ -23,6 +23,7 @@
 #define _SEGWIT_ADDR_H_ 1
 
 #include <stdint.h>
+#include <stddef.h>
 #ifdef __cplusplus
 extern "C"
 {
@@ -30,6 +31,14 @@ extern "C"
 
 #define MAX_BECH32_SIZE 1000 // for lightning
 
+/** Supported encodings. Witness v0 uses Bech32 (BIP173),
+ *  witness v1 and above use Bech32m (BIP350). */
+typedef enum {
+    BECH32_ENCODING_NONE,
+    BECH32_ENCODING_BECH32,
+    BECH32_ENCODING_BECH32M
+} bech32_encoding;
+
 /** Encode a SegWit address
  *
  *  Out: output:   Pointer to a buffer of size 73 + strlen(hrp) that will be
@@ -49,6 +58,29 @@ int segwit_addr_encode(
     size_t prog_len
 );
 
+/** Encode many SegWit addresses with the same hrp, version and program length
+ *
+ *  Out: output:      Pointer to a buffer of size count * stride, address i is
+ *                    written null-terminated at output + i * stride.
+ *  In:  stride:      Distance between addresses, at least
+ *                    strlen(hrp) + 9 + (prog_len * 8 + 4) / 5.
+ *       hrp:         Pointer to the null-terminated human readable part.
+ *       ver:         Version of the witness programs (between 0 and 16 inclusive).
+ *       progs:       Witness programs, prog_len bytes each, one after another.
+ *       prog_len:    Number of bytes in every program.
+ *       count:       Number of programs.
+ *  Returns number of encoded addresses, 0 if parameters are invalid.
+ */
+size_t segwit_addr_encode_many(
+    char *output,
+    size_t stride,
+    const char *hrp,
+    int ver,
+    const uint8_t *progs,
+    size_t prog_len,
+    size_t count
+);
+
 /** Decode a SegWit address
  *
  *  Out: ver:      Pointer to an int that will be updated to contain the witness
@@ -70,23 +102,25 @@ int segwit_addr_decode(
     const char* addr
 );
 
-/** Encode a Bech32 string
+/** Encode a Bech32 or Bech32m string
  *
  *  Out: output:  Pointer to a buffer of size strlen(hrp) + data_len + 8 that
  *                will be updated to contain the null-terminated Bech32 string.
  *  In: hrp :     Pointer to the null-terminated human readable part.
  *      data :    Pointer to an array of 5-bit values.
  *      data_len: Length of the data array.
+ *      enc:      Which encoding to use (BECH32_ENCODING_BECH32{,M}).
  *  Returns 1 if successful.
  */
 int bech32_encode(
     char *output,
     const char *hrp,
     const uint8_t *data,
-    size_t data_len
+    size_t data_len,
+    bech32_encoding enc
 );
 
-/** Decode a Bech32 string
+/** Decode a Bech32 or Bech32m string
  *
  *  Out: hrp:      Pointer to a buffer of size strlen(input) - 6. Will be
  *                 updated to contain the null-terminated human readable part.
@@ -95,9 +129,11 @@ int bech32_encode(
  *       data_len: Pointer to a size_t that will be updated to be the number
  *                 of entries in data.
  *  In: input:     Pointer to a null-terminated Bech32 string.
- *  Returns 1 if succesful.
+ *  Returns BECH32_ENCODING_BECH32{,M} to indicate decoding was successful
+ *  with the specified encoding standard. BECH32_ENCODING_NONE is returned if
+ *  decoding failed.
  */
-int bech32_decode(
+bech32_encoding bech32_decode(
     char *hrp,
     uint8_t *data,
     size_t *data_len,
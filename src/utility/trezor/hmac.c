@@ -27,8 +27,14 @@
 
 // add way how to mark confidential data
 #ifndef CONFIDENTIAL
+#if BITCOIN_THREADS
+// scratch buffers below are static, one copy per thread
+// so Transaction::signAll() workers can run RFC6979 at the same time
+#define CONFIDENTIAL __thread
+#else
 #define CONFIDENTIAL
 #endif
+#endif
 
 void hmac_sha256_Init(HMAC_SHA256_CTX *hctx, const uint8_t *key, const uint32_t keylen)
 {
@@ -666,6 +666,17 @@ char* sha1_Data(const sha2_byte* data, size_t len, char digest[SHA1_DIGEST_STRIN
 	return sha1_End(&context, digest);
 }
 
+/*** SHA-256 x86 support: *********************************************/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA256_X86 1
+#define SHA256_SHANI 1
+#include <immintrin.h>
+#include <cpuid.h>
+#else
+#define SHA256_X86 0
+#define SHA256_SHANI 0
+#endif
+
 /*** SHA-256: *********************************************************/
 void sha256_Init(SHA256_CTX* context) {
 	if (context == (SHA256_CTX*)0) {
@@ -698,7 +709,7 @@ void sha256_Init(SHA256_CTX* context) {
 	(h) = T1 + Sigma0_256(a) + Maj((a), (b), (c)); \
 	j++
 
-void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+static void sha256_Transform_generic(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
 	sha2_word32	a, b, c, d, e, f, g, h, s0, s1;
 	sha2_word32	T1;
 	sha2_word32 W256[16];
@@ -755,7 +766,7 @@ void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2
 
 #else /* SHA2_UNROLL_TRANSFORM */
 
-void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+static void sha256_Transform_generic(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
 	sha2_word32	a, b, c, d, e, f, g, h, s0, s1;
 	sha2_word32	T1, T2, W256[16];
 	int		j;
@@ -826,6 +837,396 @@ void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2
 
 #endif /* SHA2_UNROLL_TRANSFORM */
 
+/*** SHA-256 with the x86 SHA extensions: ******************************/
+/*
+ * sha256_Transform() checks CPUID once and uses the SHA-NI instructions
+ * when the CPU has them; everything built on sha256_Update() and
+ * sha256_Final() picks them up that way.
+ */
+
+#if SHA256_SHANI
+
+/* Loads state_in as ABEF / CDGH, the order _mm_sha256rnds2_epu32() wants */
+#define SHANI_LOAD_STATE(state_in) \
+	TMP = _mm_loadu_si128((const __m128i*)(state_in)); \
+	STATE1 = _mm_loadu_si128((const __m128i*)((state_in) + 4)); \
+	TMP = _mm_shuffle_epi32(TMP, 0xB1); \
+	STATE1 = _mm_shuffle_epi32(STATE1, 0x1B); \
+	STATE0 = _mm_alignr_epi8(TMP, STATE1, 8); \
+	STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0); \
+	ABEF_SAVE = STATE0; \
+	CDGH_SAVE = STATE1
+
+#define SHANI_STORE_STATE(state_out) \
+	STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE); \
+	STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE); \
+	TMP = _mm_shuffle_epi32(STATE0, 0x1B); \
+	STATE1 = _mm_shuffle_epi32(STATE1, 0xB1); \
+	STATE0 = _mm_blend_epi16(TMP, STATE1, 0xF0); \
+	STATE1 = _mm_alignr_epi8(STATE1, TMP, 8); \
+	_mm_storeu_si128((__m128i*)(state_out), STATE0); \
+	_mm_storeu_si128((__m128i*)((state_out) + 4), STATE1)
+
+__attribute__((target("sha,sse4.1")))
+static void sha256_Transform_shani(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+	__m128i	STATE0, STATE1, MSG, TMP, MSG0, MSG1, MSG2, MSG3, ABEF_SAVE, CDGH_SAVE;
+
+	SHANI_LOAD_STATE(state_in);
+
+	/* Rounds 0-3 */
+	MSG0 = _mm_loadu_si128((const __m128i*)(data + 0));
+	MSG = _mm_add_epi32(MSG0, _mm_loadu_si128((const __m128i*)(K256 + 0)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+	/* Rounds 4-7 */
+	MSG1 = _mm_loadu_si128((const __m128i*)(data + 4));
+	MSG = _mm_add_epi32(MSG1, _mm_loadu_si128((const __m128i*)(K256 + 4)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG0 = _mm_sha256msg1_epu32(MSG0, MSG1);
+
+	/* Rounds 8-11 */
+	MSG2 = _mm_loadu_si128((const __m128i*)(data + 8));
+	MSG = _mm_add_epi32(MSG2, _mm_loadu_si128((const __m128i*)(K256 + 8)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG1 = _mm_sha256msg1_epu32(MSG1, MSG2);
+
+	/* Rounds 12-15 */
+	MSG3 = _mm_loadu_si128((const __m128i*)(data + 12));
+	MSG = _mm_add_epi32(MSG3, _mm_loadu_si128((const __m128i*)(K256 + 12)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG3, MSG2, 4);
+	MSG0 = _mm_add_epi32(MSG0, TMP);
+	MSG0 = _mm_sha256msg2_epu32(MSG0, MSG3);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG2 = _mm_sha256msg1_epu32(MSG2, MSG3);
+
+	/* Rounds 16-19 */
+	MSG = _mm_add_epi32(MSG0, _mm_loadu_si128((const __m128i*)(K256 + 16)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG0, MSG3, 4);
+	MSG1 = _mm_add_epi32(MSG1, TMP);
+	MSG1 = _mm_sha256msg2_epu32(MSG1, MSG0);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG3 = _mm_sha256msg1_epu32(MSG3, MSG0);
+
+	/* Rounds 20-23 */
+	MSG = _mm_add_epi32(MSG1, _mm_loadu_si128((const __m128i*)(K256 + 20)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG1, MSG0, 4);
+	MSG2 = _mm_add_epi32(MSG2, TMP);
+	MSG2 = _mm_sha256msg2_epu32(MSG2, MSG1);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG0 = _mm_sha256msg1_epu32(MSG0, MSG1);
+
+	/* Rounds 24-27 */
+	MSG = _mm_add_epi32(MSG2, _mm_loadu_si128((const __m128i*)(K256 + 24)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG2, MSG1, 4);
+	MSG3 = _mm_add_epi32(MSG3, TMP);
+	MSG3 = _mm_sha256msg2_epu32(MSG3, MSG2);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG1 = _mm_sha256msg1_epu32(MSG1, MSG2);
+
+	/* Rounds 28-31 */
+	MSG = _mm_add_epi32(MSG3, _mm_loadu_si128((const __m128i*)(K256 + 28)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG3, MSG2, 4);
+	MSG0 = _mm_add_epi32(MSG0, TMP);
+	MSG0 = _mm_sha256msg2_epu32(MSG0, MSG3);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG2 = _mm_sha256msg1_epu32(MSG2, MSG3);
+
+	/* Rounds 32-35 */
+	MSG = _mm_add_epi32(MSG0, _mm_loadu_si128((const __m128i*)(K256 + 32)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG0, MSG3, 4);
+	MSG1 = _mm_add_epi32(MSG1, TMP);
+	MSG1 = _mm_sha256msg2_epu32(MSG1, MSG0);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG3 = _mm_sha256msg1_epu32(MSG3, MSG0);
+
+	/* Rounds 36-39 */
+	MSG = _mm_add_epi32(MSG1, _mm_loadu_si128((const __m128i*)(K256 + 36)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG1, MSG0, 4);
+	MSG2 = _mm_add_epi32(MSG2, TMP);
+	MSG2 = _mm_sha256msg2_epu32(MSG2, MSG1);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG0 = _mm_sha256msg1_epu32(MSG0, MSG1);
+
+	/* Rounds 40-43 */
+	MSG = _mm_add_epi32(MSG2, _mm_loadu_si128((const __m128i*)(K256 + 40)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG2, MSG1, 4);
+	MSG3 = _mm_add_epi32(MSG3, TMP);
+	MSG3 = _mm_sha256msg2_epu32(MSG3, MSG2);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG1 = _mm_sha256msg1_epu32(MSG1, MSG2);
+
+	/* Rounds 44-47 */
+	MSG = _mm_add_epi32(MSG3, _mm_loadu_si128((const __m128i*)(K256 + 44)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG3, MSG2, 4);
+	MSG0 = _mm_add_epi32(MSG0, TMP);
+	MSG0 = _mm_sha256msg2_epu32(MSG0, MSG3);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG2 = _mm_sha256msg1_epu32(MSG2, MSG3);
+
+	/* Rounds 48-51 */
+	MSG = _mm_add_epi32(MSG0, _mm_loadu_si128((const __m128i*)(K256 + 48)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG0, MSG3, 4);
+	MSG1 = _mm_add_epi32(MSG1, TMP);
+	MSG1 = _mm_sha256msg2_epu32(MSG1, MSG0);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG3 = _mm_sha256msg1_epu32(MSG3, MSG0);
+
+	/* Rounds 52-55 */
+	MSG = _mm_add_epi32(MSG1, _mm_loadu_si128((const __m128i*)(K256 + 52)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG1, MSG0, 4);
+	MSG2 = _mm_add_epi32(MSG2, TMP);
+	MSG2 = _mm_sha256msg2_epu32(MSG2, MSG1);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+	/* Rounds 56-59 */
+	MSG = _mm_add_epi32(MSG2, _mm_loadu_si128((const __m128i*)(K256 + 56)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	TMP = _mm_alignr_epi8(MSG2, MSG1, 4);
+	MSG3 = _mm_add_epi32(MSG3, TMP);
+	MSG3 = _mm_sha256msg2_epu32(MSG3, MSG2);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+	/* Rounds 60-63 */
+	MSG = _mm_add_epi32(MSG3, _mm_loadu_si128((const __m128i*)(K256 + 60)));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+	SHANI_STORE_STATE(state_out);
+}
+
+/* Same as above for a block whose W[j] + K256[j] are precomputed in wk */
+__attribute__((target("sha,sse4.1")))
+static void sha256_Transform_wk_shani(const sha2_word32* state_in, const sha2_word32* wk, sha2_word32* state_out) {
+	__m128i	STATE0, STATE1, MSG, TMP, ABEF_SAVE, CDGH_SAVE;
+
+	SHANI_LOAD_STATE(state_in);
+
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 0));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 4));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 8));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 12));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 16));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 20));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 24));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 28));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 32));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 36));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 40));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 44));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 48));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 52));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 56));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+	MSG = _mm_loadu_si128((const __m128i*)(wk + 60));
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+	MSG = _mm_shuffle_epi32(MSG, 0x0E);
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+	SHANI_STORE_STATE(state_out);
+}
+
+#undef SHANI_LOAD_STATE
+#undef SHANI_STORE_STATE
+
+static int sha256_shani_supported(void) {
+	static volatile int supported = -1;
+	unsigned int a, b, c, d;
+
+	if (supported < 0) {
+		int s = 0;
+		/* SSSE3 and SSE4.1 for the shuffles, then the SHA extensions */
+		if (__get_cpuid(1, &a, &b, &c, &d) && (c & bit_SSSE3) && (c & bit_SSE4_1) &&
+		    __get_cpuid_max(0, 0) >= 7) {
+			__cpuid_count(7, 0, a, b, c, d);
+			s = (b & (1u << 29)) != 0;
+		}
+		supported = s;
+	}
+	return supported;
+}
+
+#endif /* SHA256_SHANI */
+
+void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+#if SHA256_SHANI
+	if (sha256_shani_supported()) {
+		sha256_Transform_shani(state_in, data, state_out);
+		return;
+	}
+#endif
+	sha256_Transform_generic(state_in, data, state_out);
+}
+
+/* W[j] + K256[j] of the padding block that follows a 64-byte message */
+static const sha2_word32 sha256_pad64_wk[64] = {
+	0xc28a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL,
+	0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
+	0xd807aa98UL, 0x12835b01UL, 0x243185beUL, 0x550c7dc3UL,
+	0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL, 0xc19bf374UL,
+	0x649b69c1UL, 0xf0fe4786UL, 0x0fe1edc6UL, 0x240cf254UL,
+	0x4fe9346fUL, 0x6cc984beUL, 0x61b9411eUL, 0x16f988faUL,
+	0xf2c65152UL, 0xa88e5a6dUL, 0xb019fc65UL, 0xb9d99ec7UL,
+	0x9a1231c3UL, 0xe70eeaa0UL, 0xfdb1232bUL, 0xc7353eb0UL,
+	0x3069bad5UL, 0xcb976d5fUL, 0x5a0f118fUL, 0xdc1eeefdUL,
+	0x0a35b689UL, 0xde0b7a04UL, 0x58f4ca9dUL, 0xe15d5b16UL,
+	0x007f3e86UL, 0x37088980UL, 0xa507ea32UL, 0x6fab9537UL,
+	0x17406110UL, 0x0d8cd6f1UL, 0xcdaa3b6dUL, 0xc0bbbe37UL,
+	0x83613bdaUL, 0xdb48a363UL, 0x0b02e931UL, 0x6fd15ca7UL,
+	0x521afacaUL, 0x31338431UL, 0x6ed41a95UL, 0x6d437890UL,
+	0xc39c91f2UL, 0x9eccabbdUL, 0xb5c9a0e6UL, 0x532fb63cUL,
+	0xd2c741c6UL, 0x07237ea3UL, 0xa4954b68UL, 0x4c191d76UL,
+};
+
+/* sha256_Transform() for a block with a precomputed schedule */
+static void sha256_Transform_wk(const sha2_word32* state_in, const sha2_word32* wk, sha2_word32* state_out) {
+	sha2_word32	a, b, c, d, e, f, g, h, T1, T2;
+	int		j;
+
+#if SHA256_SHANI
+	if (sha256_shani_supported()) {
+		sha256_Transform_wk_shani(state_in, wk, state_out);
+		return;
+	}
+#endif
+	a = state_in[0];
+	b = state_in[1];
+	c = state_in[2];
+	d = state_in[3];
+	e = state_in[4];
+	f = state_in[5];
+	g = state_in[6];
+	h = state_in[7];
+
+	for (j = 0; j < 64; j++) {
+		T1 = h + Sigma1_256(e) + Ch(e, f, g) + wk[j];
+		T2 = Sigma0_256(a) + Maj(a, b, c);
+		h = g;
+		g = f;
+		f = e;
+		e = d + T1;
+		d = c;
+		c = b;
+		b = a;
+		a = T1 + T2;
+	}
+
+	state_out[0] = state_in[0] + a;
+	state_out[1] = state_in[1] + b;
+	state_out[2] = state_in[2] + c;
+	state_out[3] = state_in[3] + d;
+	state_out[4] = state_in[4] + e;
+	state_out[5] = state_in[5] + f;
+	state_out[6] = state_in[6] + g;
+	state_out[7] = state_in[7] + h;
+}
+
+/* sha256(sha256(data)) of exactly 64 bytes, e.g. a pair of Merkle tree nodes */
+void sha256d_64(const uint8_t* data, uint8_t digest[SHA256_DIGEST_LENGTH]) {
+	sha2_word32	W[16], state[8];
+	int		j;
+
+	for (j = 0; j < 16; j++) {
+		W[j] = ((sha2_word32)data[4 * j] << 24) | ((sha2_word32)data[4 * j + 1] << 16) |
+		       ((sha2_word32)data[4 * j + 2] << 8) | (sha2_word32)data[4 * j + 3];
+	}
+	sha256_Transform(sha256_initial_hash_value, W, state);
+	sha256_Transform_wk(state, sha256_pad64_wk, state);
+
+	/* the second hash is a single block: 32 bytes of digest and padding */
+	for (j = 0; j < 8; j++) {
+		W[j] = state[j];
+	}
+	W[8] = 0x80000000UL;
+	for (j = 9; j < 15; j++) {
+		W[j] = 0;
+	}
+	W[15] = SHA256_DIGEST_LENGTH << 3;
+	sha256_Transform(sha256_initial_hash_value, W, state);
+
+	for (j = 0; j < 8; j++) {
+		digest[4 * j] = (sha2_byte)(state[j] >> 24);
+		digest[4 * j + 1] = (sha2_byte)(state[j] >> 16);
+		digest[4 * j + 2] = (sha2_byte)(state[j] >> 8);
+		digest[4 * j + 3] = (sha2_byte)state[j];
+	}
+	memzero(W, sizeof(W));
+	memzero(state, sizeof(state));
+}
+
 void sha256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 	unsigned int	freespace, usedspace;
 
@@ -974,6 +1375,266 @@ char* sha256_Data(const sha2_byte* data, size_t len, char digest[SHA256_DIGEST_S
 }
 
 
+/*** SHA-256 multi-buffer: ********************************************/
+/*
+ * Hashes of many independent messages of the same length, computed in
+ * SIMD lanes: 8 with AVX2 and 4 with SSE2, picked at runtime, or one
+ * at a time with sha256_Transform() everywhere else.  Block data is
+ * passed as raw message bytes, lane states in host order.
+ */
+
+#if SHA256_X86 && defined(__SSE2__)
+#define SHA256_X86_LANES 1
+#define SHA256_MANY_LANES SHA256_LANES
+#else
+#define SHA256_X86_LANES 0
+/* keeps sha256_many() small on the stack */
+#define SHA256_MANY_LANES 1
+#endif
+
+#define BE32(p)	(((sha2_word32)(p)[0] << 24) | ((sha2_word32)(p)[1] << 16) | \
+		 ((sha2_word32)(p)[2] << 8) | (sha2_word32)(p)[3])
+
+static void sha256_transform_lanes_scalar(sha2_word32 state[][8], const sha2_byte* blocks[], int lanes) {
+	sha2_word32	W[16];
+	int		l, j;
+
+	for (l = 0; l < lanes; l++) {
+		for (j = 0; j < 16; j++) {
+			W[j] = BE32(blocks[l] + 4 * j);
+		}
+		sha256_Transform(state[l], W, state[l]);
+	}
+	memzero(W, sizeof(W));
+}
+
+#if SHA256_X86_LANES
+
+#define X4_ROTR(x,n)	_mm_or_si128(_mm_srli_epi32((x), (n)), _mm_slli_epi32((x), 32 - (n)))
+#define X4_XOR3(x,y,z)	_mm_xor_si128(_mm_xor_si128((x), (y)), (z))
+#define X4_ADD3(x,y,z)	_mm_add_epi32(_mm_add_epi32((x), (y)), (z))
+
+/* one round; W is expanded in place from round 16 on */
+#define X4_ROUND(a,b,c,d,e,f,g,h,k)	\
+	if (j) { \
+		s0 = W[((k)+1)&0x0f]; \
+		s1 = W[((k)+14)&0x0f]; \
+		s0 = X4_XOR3(X4_ROTR(s0, 7), X4_ROTR(s0, 18), _mm_srli_epi32(s0, 3)); \
+		s1 = X4_XOR3(X4_ROTR(s1, 17), X4_ROTR(s1, 19), _mm_srli_epi32(s1, 10)); \
+		W[k] = _mm_add_epi32(X4_ADD3(W[k], s0, s1), W[((k)+9)&0x0f]); \
+	} \
+	T1 = X4_ADD3((h), X4_XOR3(X4_ROTR((e), 6), X4_ROTR((e), 11), X4_ROTR((e), 25)), \
+		_mm_xor_si128(_mm_and_si128((e), (f)), _mm_andnot_si128((e), (g)))); \
+	T1 = X4_ADD3(T1, _mm_set1_epi32(K256[j + (k)]), W[k]); \
+	(d) = _mm_add_epi32((d), T1); \
+	(h) = X4_ADD3(T1, X4_XOR3(X4_ROTR((a), 2), X4_ROTR((a), 13), X4_ROTR((a), 22)), \
+		_mm_or_si128(_mm_and_si128((a), (b)), _mm_and_si128((c), _mm_or_si128((a), (b)))))
+
+static void sha256_transform_x4_sse2(sha2_word32 state[][8], const sha2_byte* blocks[]) {
+	__m128i		a, b, c, d, e, f, g, h, s0, s1, T1, W[16];
+	sha2_word32	out[4];
+	int		j, l;
+
+	a = _mm_set_epi32(state[3][0], state[2][0], state[1][0], state[0][0]);
+	b = _mm_set_epi32(state[3][1], state[2][1], state[1][1], state[0][1]);
+	c = _mm_set_epi32(state[3][2], state[2][2], state[1][2], state[0][2]);
+	d = _mm_set_epi32(state[3][3], state[2][3], state[1][3], state[0][3]);
+	e = _mm_set_epi32(state[3][4], state[2][4], state[1][4], state[0][4]);
+	f = _mm_set_epi32(state[3][5], state[2][5], state[1][5], state[0][5]);
+	g = _mm_set_epi32(state[3][6], state[2][6], state[1][6], state[0][6]);
+	h = _mm_set_epi32(state[3][7], state[2][7], state[1][7], state[0][7]);
+
+	for (j = 0; j < 16; j++) {
+		W[j] = _mm_set_epi32(BE32(blocks[3] + 4 * j), BE32(blocks[2] + 4 * j),
+				     BE32(blocks[1] + 4 * j), BE32(blocks[0] + 4 * j));
+	}
+	/* 16 rounds per pass, so that all W indexes are constant */
+	for (j = 0; j < 64; j += 16) {
+		X4_ROUND(a,b,c,d,e,f,g,h,0);
+		X4_ROUND(h,a,b,c,d,e,f,g,1);
+		X4_ROUND(g,h,a,b,c,d,e,f,2);
+		X4_ROUND(f,g,h,a,b,c,d,e,3);
+		X4_ROUND(e,f,g,h,a,b,c,d,4);
+		X4_ROUND(d,e,f,g,h,a,b,c,5);
+		X4_ROUND(c,d,e,f,g,h,a,b,6);
+		X4_ROUND(b,c,d,e,f,g,h,a,7);
+		X4_ROUND(a,b,c,d,e,f,g,h,8);
+		X4_ROUND(h,a,b,c,d,e,f,g,9);
+		X4_ROUND(g,h,a,b,c,d,e,f,10);
+		X4_ROUND(f,g,h,a,b,c,d,e,11);
+		X4_ROUND(e,f,g,h,a,b,c,d,12);
+		X4_ROUND(d,e,f,g,h,a,b,c,13);
+		X4_ROUND(c,d,e,f,g,h,a,b,14);
+		X4_ROUND(b,c,d,e,f,g,h,a,15);
+	}
+
+#define X4_STORE(v,i)	_mm_storeu_si128((__m128i*)out, (v)); \
+	for (l = 0; l < 4; l++) { state[l][i] += out[l]; }
+	X4_STORE(a, 0); X4_STORE(b, 1); X4_STORE(c, 2); X4_STORE(d, 3);
+	X4_STORE(e, 4); X4_STORE(f, 5); X4_STORE(g, 6); X4_STORE(h, 7);
+#undef X4_STORE
+}
+
+#define X8_ROTR(x,n)	_mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+#define X8_XOR3(x,y,z)	_mm256_xor_si256(_mm256_xor_si256((x), (y)), (z))
+#define X8_ADD3(x,y,z)	_mm256_add_epi32(_mm256_add_epi32((x), (y)), (z))
+#define X8_ROUND(a,b,c,d,e,f,g,h,k)	\
+	if (j) { \
+		s0 = W[((k)+1)&0x0f]; \
+		s1 = W[((k)+14)&0x0f]; \
+		s0 = X8_XOR3(X8_ROTR(s0, 7), X8_ROTR(s0, 18), _mm256_srli_epi32(s0, 3)); \
+		s1 = X8_XOR3(X8_ROTR(s1, 17), X8_ROTR(s1, 19), _mm256_srli_epi32(s1, 10)); \
+		W[k] = _mm256_add_epi32(X8_ADD3(W[k], s0, s1), W[((k)+9)&0x0f]); \
+	} \
+	T1 = X8_ADD3((h), X8_XOR3(X8_ROTR((e), 6), X8_ROTR((e), 11), X8_ROTR((e), 25)), \
+		_mm256_xor_si256(_mm256_and_si256((e), (f)), _mm256_andnot_si256((e), (g)))); \
+	T1 = X8_ADD3(T1, _mm256_set1_epi32(K256[j + (k)]), W[k]); \
+	(d) = _mm256_add_epi32((d), T1); \
+	(h) = X8_ADD3(T1, X8_XOR3(X8_ROTR((a), 2), X8_ROTR((a), 13), X8_ROTR((a), 22)), \
+		_mm256_or_si256(_mm256_and_si256((a), (b)), _mm256_and_si256((c), _mm256_or_si256((a), (b)))))
+#define X8_SET(i)	_mm256_set_epi32(state[7][i], state[6][i], state[5][i], state[4][i], \
+				 state[3][i], state[2][i], state[1][i], state[0][i])
+
+__attribute__((target("avx2")))
+static void sha256_transform_x8_avx2(sha2_word32 state[][8], const sha2_byte* blocks[]) {
+	__m256i		a, b, c, d, e, f, g, h, s0, s1, T1, W[16];
+	sha2_word32	out[8];
+	int		j, l;
+
+	a = X8_SET(0); b = X8_SET(1); c = X8_SET(2); d = X8_SET(3);
+	e = X8_SET(4); f = X8_SET(5); g = X8_SET(6); h = X8_SET(7);
+
+	for (j = 0; j < 16; j++) {
+		W[j] = _mm256_set_epi32(BE32(blocks[7] + 4 * j), BE32(blocks[6] + 4 * j),
+					BE32(blocks[5] + 4 * j), BE32(blocks[4] + 4 * j),
+					BE32(blocks[3] + 4 * j), BE32(blocks[2] + 4 * j),
+					BE32(blocks[1] + 4 * j), BE32(blocks[0] + 4 * j));
+	}
+	/* 16 rounds per pass, so that all W indexes are constant */
+	for (j = 0; j < 64; j += 16) {
+		X8_ROUND(a,b,c,d,e,f,g,h,0);
+		X8_ROUND(h,a,b,c,d,e,f,g,1);
+		X8_ROUND(g,h,a,b,c,d,e,f,2);
+		X8_ROUND(f,g,h,a,b,c,d,e,3);
+		X8_ROUND(e,f,g,h,a,b,c,d,4);
+		X8_ROUND(d,e,f,g,h,a,b,c,5);
+		X8_ROUND(c,d,e,f,g,h,a,b,6);
+		X8_ROUND(b,c,d,e,f,g,h,a,7);
+		X8_ROUND(a,b,c,d,e,f,g,h,8);
+		X8_ROUND(h,a,b,c,d,e,f,g,9);
+		X8_ROUND(g,h,a,b,c,d,e,f,10);
+		X8_ROUND(f,g,h,a,b,c,d,e,11);
+		X8_ROUND(e,f,g,h,a,b,c,d,12);
+		X8_ROUND(d,e,f,g,h,a,b,c,13);
+		X8_ROUND(c,d,e,f,g,h,a,b,14);
+		X8_ROUND(b,c,d,e,f,g,h,a,15);
+	}
+
+#define X8_STORE(v,i)	_mm256_storeu_si256((__m256i*)out, (v)); \
+	for (l = 0; l < 8; l++) { state[l][i] += out[l]; }
+	X8_STORE(a, 0); X8_STORE(b, 1); X8_STORE(c, 2); X8_STORE(d, 3);
+	X8_STORE(e, 4); X8_STORE(f, 5); X8_STORE(g, 6); X8_STORE(h, 7);
+#undef X8_STORE
+}
+
+/* 8 with AVX2, 4 with SSE2 */
+static int sha256_x86_lanes(void) {
+	static volatile int lanes = 0;
+	if (lanes == 0) {
+		__builtin_cpu_init();
+		lanes = __builtin_cpu_supports("avx2") ? 8 : 4;
+	}
+	return lanes;
+}
+
+#endif /* SHA256_X86_LANES */
+
+/* Runs one block through the first `lanes` states; unused lanes may be garbage. */
+static void sha256_transform_lanes(sha2_word32 state[][8], const sha2_byte* blocks[], int lanes) {
+#if SHA256_X86_LANES
+	/* one SHA-NI block is cheaper than a lane of the vector code */
+	if (sha256_shani_supported()) {
+		sha256_transform_lanes_scalar(state, blocks, lanes);
+		return;
+	}
+	if (lanes > 4 && sha256_x86_lanes() == 8) {
+		sha256_transform_x8_avx2(state, blocks);
+		return;
+	}
+	if (lanes >= 2) {
+		sha256_transform_x4_sse2(state, blocks);
+		if (lanes > 4) {
+			sha256_transform_x4_sse2(state + 4, blocks + 4);
+		}
+		return;
+	}
+#endif
+	sha256_transform_lanes_scalar(state, blocks, lanes);
+}
+
+void sha256_Transform_x8(uint32_t state[SHA256_LANES][8], const uint8_t* blocks[SHA256_LANES]) {
+	sha256_transform_lanes(state, blocks, SHA256_LANES);
+}
+
+void sha256_many(const uint8_t* data, size_t len, size_t count, uint8_t* digests) {
+	sha2_word32	state[SHA256_MANY_LANES][8];
+	sha2_byte	tail[SHA256_MANY_LANES][2 * SHA256_BLOCK_LENGTH];
+	const sha2_byte	*blocks[SHA256_MANY_LANES];
+	size_t		full = len / SHA256_BLOCK_LENGTH;
+	size_t		rest = len % SHA256_BLOCK_LENGTH;
+	/* the padding takes one more block if the length doesn't fit after the message */
+	size_t		tails = (rest < SHA256_SHORT_BLOCK_LENGTH) ? 1 : 2;
+	uint64_t	bitcount = (uint64_t)len << 3;
+	size_t		i, k;
+	int		lanes, l, j;
+
+	for (i = 0; i < count; i += SHA256_MANY_LANES) {
+		lanes = (count - i < SHA256_MANY_LANES) ? (int)(count - i) : SHA256_MANY_LANES;
+		for (l = 0; l < SHA256_MANY_LANES; l++) {
+			MEMCPY_BCOPY(state[l], sha256_initial_hash_value, SHA256_DIGEST_LENGTH);
+			/* spare lanes repeat the first message */
+			blocks[l] = data + (i + (l < lanes ? l : 0)) * len;
+		}
+		for (k = 0; k < full; k++) {
+			sha256_transform_lanes(state, blocks, lanes);
+			for (l = 0; l < SHA256_MANY_LANES; l++) {
+				blocks[l] += SHA256_BLOCK_LENGTH;
+			}
+		}
+		for (l = 0; l < lanes; l++) {
+			MEMCPY_BCOPY(tail[l], blocks[l], rest);
+			tail[l][rest] = 0x80;
+			memset(tail[l] + rest + 1, 0, tails * SHA256_BLOCK_LENGTH - rest - 9);
+			for (j = 0; j < 8; j++) {
+				tail[l][tails * SHA256_BLOCK_LENGTH - 1 - j] = (sha2_byte)(bitcount >> (8 * j));
+			}
+		}
+		for (k = 0; k < tails; k++) {
+			for (l = 0; l < SHA256_MANY_LANES; l++) {
+				blocks[l] = tail[l < lanes ? l : 0] + k * SHA256_BLOCK_LENGTH;
+			}
+			sha256_transform_lanes(state, blocks, lanes);
+		}
+		for (l = 0; l < lanes; l++) {
+			for (j = 0; j < 8; j++) {
+				digests[(i + l) * SHA256_DIGEST_LENGTH + 4 * j + 0] = (sha2_byte)(state[l][j] >> 24);
+				digests[(i + l) * SHA256_DIGEST_LENGTH + 4 * j + 1] = (sha2_byte)(state[l][j] >> 16);
+				digests[(i + l) * SHA256_DIGEST_LENGTH + 4 * j + 2] = (sha2_byte)(state[l][j] >> 8);
+				digests[(i + l) * SHA256_DIGEST_LENGTH + 4 * j + 3] = (sha2_byte)state[l][j];
+			}
+		}
+	}
+	memzero(state, sizeof(state));
+	memzero(tail, sizeof(tail));
+}
+
+void sha256d_many(const uint8_t* data, size_t len, size_t count, uint8_t* digests) {
+	sha256_many(data, len, count, digests);
+	sha256_many(digests, SHA256_DIGEST_LENGTH, count, digests);
+}
+
+#undef BE32
+
 /*** SHA-512: *********************************************************/
 void sha512_Init(SHA512_CTX* context) {
 	if (context == (SHA512_CTX*)0) {
@@ -1267,6 +1928,107 @@ char *sha512_End(SHA512_CTX* context, char buffer[]) {
 	return buffer;
 }
 
+/*** SHA-512 multi-buffer: ********************************************/
+/*
+ * Four independent SHA-512 blocks at once in the 64-bit lanes of AVX2,
+ * picked at runtime, or one after another with sha512_Transform().
+ * Data is in host order like for sha512_Transform(), so word-level
+ * loops such as PBKDF2 don't convert bytes between blocks.
+ */
+
+#if SHA256_X86
+
+#define X4_512_ROTR(x,n)	_mm256_or_si256(_mm256_srli_epi64((x), (n)), _mm256_slli_epi64((x), 64 - (n)))
+#define X4_512_XOR3(x,y,z)	_mm256_xor_si256(_mm256_xor_si256((x), (y)), (z))
+#define X4_512_ADD3(x,y,z)	_mm256_add_epi64(_mm256_add_epi64((x), (y)), (z))
+
+/* one round; W is expanded in place from round 16 on */
+#define X4_512_ROUND(a,b,c,d,e,f,g,h,k)	\
+	if (j) { \
+		s0 = W[((k)+1)&0x0f]; \
+		s1 = W[((k)+14)&0x0f]; \
+		s0 = X4_512_XOR3(X4_512_ROTR(s0, 1), X4_512_ROTR(s0, 8), _mm256_srli_epi64(s0, 7)); \
+		s1 = X4_512_XOR3(X4_512_ROTR(s1, 19), X4_512_ROTR(s1, 61), _mm256_srli_epi64(s1, 6)); \
+		W[k] = _mm256_add_epi64(X4_512_ADD3(W[k], s0, s1), W[((k)+9)&0x0f]); \
+	} \
+	T1 = X4_512_ADD3((h), X4_512_XOR3(X4_512_ROTR((e), 14), X4_512_ROTR((e), 18), X4_512_ROTR((e), 41)), \
+		_mm256_xor_si256(_mm256_and_si256((e), (f)), _mm256_andnot_si256((e), (g)))); \
+	T1 = X4_512_ADD3(T1, _mm256_set1_epi64x((long long)K512[j + (k)]), W[k]); \
+	(d) = _mm256_add_epi64((d), T1); \
+	(h) = X4_512_ADD3(T1, X4_512_XOR3(X4_512_ROTR((a), 28), X4_512_ROTR((a), 34), X4_512_ROTR((a), 39)), \
+		_mm256_or_si256(_mm256_and_si256((a), (b)), _mm256_and_si256((c), _mm256_or_si256((a), (b)))))
+
+#define X4_512_SET(v,i)	_mm256_set_epi64x((long long)(v)[3][i], (long long)(v)[2][i], \
+				  (long long)(v)[1][i], (long long)(v)[0][i])
+
+__attribute__((target("avx2")))
+static void sha512_transform_x4_avx2(const sha2_word64 state_in[][8], const sha2_word64 data[][16], sha2_word64 state_out[][8]) {
+	__m256i		a, b, c, d, e, f, g, h, s0, s1, T1, W[16];
+	sha2_word64	out[4];
+	int		j, l;
+
+	a = X4_512_SET(state_in, 0); b = X4_512_SET(state_in, 1);
+	c = X4_512_SET(state_in, 2); d = X4_512_SET(state_in, 3);
+	e = X4_512_SET(state_in, 4); f = X4_512_SET(state_in, 5);
+	g = X4_512_SET(state_in, 6); h = X4_512_SET(state_in, 7);
+
+	for (j = 0; j < 16; j++) {
+		W[j] = X4_512_SET(data, j);
+	}
+	/* 16 rounds per pass, so that all W indexes are constant */
+	for (j = 0; j < 80; j += 16) {
+		X4_512_ROUND(a,b,c,d,e,f,g,h,0);
+		X4_512_ROUND(h,a,b,c,d,e,f,g,1);
+		X4_512_ROUND(g,h,a,b,c,d,e,f,2);
+		X4_512_ROUND(f,g,h,a,b,c,d,e,3);
+		X4_512_ROUND(e,f,g,h,a,b,c,d,4);
+		X4_512_ROUND(d,e,f,g,h,a,b,c,5);
+		X4_512_ROUND(c,d,e,f,g,h,a,b,6);
+		X4_512_ROUND(b,c,d,e,f,g,h,a,7);
+		X4_512_ROUND(a,b,c,d,e,f,g,h,8);
+		X4_512_ROUND(h,a,b,c,d,e,f,g,9);
+		X4_512_ROUND(g,h,a,b,c,d,e,f,10);
+		X4_512_ROUND(f,g,h,a,b,c,d,e,11);
+		X4_512_ROUND(e,f,g,h,a,b,c,d,12);
+		X4_512_ROUND(d,e,f,g,h,a,b,c,13);
+		X4_512_ROUND(c,d,e,f,g,h,a,b,14);
+		X4_512_ROUND(b,c,d,e,f,g,h,a,15);
+	}
+
+#define X4_512_STORE(v,i)	_mm256_storeu_si256((__m256i*)out, (v)); \
+	for (l = 0; l < 4; l++) { state_out[l][i] = state_in[l][i] + out[l]; }
+	X4_512_STORE(a, 0); X4_512_STORE(b, 1); X4_512_STORE(c, 2); X4_512_STORE(d, 3);
+	X4_512_STORE(e, 4); X4_512_STORE(f, 5); X4_512_STORE(g, 6); X4_512_STORE(h, 7);
+#undef X4_512_STORE
+}
+
+#undef X4_512_SET
+
+static int sha512_avx2_supported(void) {
+	static volatile int supported = -1;
+	if (supported < 0) {
+		__builtin_cpu_init();
+		supported = __builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+	return supported;
+}
+
+#endif /* SHA256_X86 */
+
+void sha512_Transform_x4(const uint64_t state_in[SHA512_LANES][8], const uint64_t data[SHA512_LANES][16], uint64_t state_out[SHA512_LANES][8]) {
+	int	l;
+
+#if SHA256_X86
+	if (sha512_avx2_supported()) {
+		sha512_transform_x4_avx2(state_in, data, state_out);
+		return;
+	}
+#endif
+	for (l = 0; l < SHA512_LANES; l++) {
+		sha512_Transform(state_in[l], data[l], state_out[l]);
+	}
+}
+
 void sha512_Raw(const sha2_byte* data, size_t len, uint8_t digest[SHA512_DIGEST_LENGTH]) {
 	SHA512_CTX	context;
 	sha512_Init(&context);
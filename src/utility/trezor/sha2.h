@@ -40,9 +40,11 @@
 #define SHA256_BLOCK_LENGTH		64
 #define SHA256_DIGEST_LENGTH		32
 #define SHA256_DIGEST_STRING_LENGTH	(SHA256_DIGEST_LENGTH * 2 + 1)
+#define SHA256_LANES			8
 #define SHA512_BLOCK_LENGTH		128
 #define SHA512_DIGEST_LENGTH		64
 #define SHA512_DIGEST_STRING_LENGTH	(SHA512_DIGEST_LENGTH * 2 + 1)
+#define SHA512_LANES			4
 
 typedef struct _SHA1_CTX {
 	uint32_t	state[5];
@@ -110,7 +112,14 @@ char* sha256_End(SHA256_CTX*, char[SHA256_DIGEST_STRING_LENGTH]);
 void sha256_Raw(const uint8_t*, size_t, uint8_t[SHA256_DIGEST_LENGTH]);
 char* sha256_Data(const uint8_t*, size_t, char[SHA256_DIGEST_STRING_LENGTH]);
 
+/* Independent messages hashed in parallel, see sha2.c */
+void sha256_Transform_x8(uint32_t state[SHA256_LANES][8], const uint8_t* blocks[SHA256_LANES]);
+void sha256_many(const uint8_t* data, size_t len, size_t count, uint8_t* digests);
+void sha256d_many(const uint8_t* data, size_t len, size_t count, uint8_t* digests);
+void sha256d_64(const uint8_t* data, uint8_t digest[SHA256_DIGEST_LENGTH]);
+
 void sha512_Transform(const uint64_t* state_in, const uint64_t* data, uint64_t* state_out);
+void sha512_Transform_x4(const uint64_t state_in[SHA512_LANES][8], const uint64_t data[SHA512_LANES][16], uint64_t state_out[SHA512_LANES][8]);
 void sha512_Init(SHA512_CTX*);
 void sha512_Update(SHA512_CTX*, const uint8_t*, size_t);
 void sha512_Final(SHA512_CTX*, uint8_t[SHA512_DIGEST_LENGTH]);
@@ -0,0 +1,86 @@
+#include <Bitcoin.h>
+#define VERBOSE false
+
+void result(const char * name, bool ok){
+  if(VERBOSE){
+    Serial.println(name);
+  }
+  if(ok){
+    Serial.println("OK. Test passed");
+  }else{
+    Serial.println("ERROR. Test failed");
+  }
+}
+
+// encodes hex data and decodes it back
+void testBase58(char * hex, char * encoded){
+  uint8_t data[50];
+  size_t len = fromHex(hex, strlen(hex), data, sizeof(data));
+  char out[100] = { 0 };
+  size_t outLen = toBase58(data, len, out, sizeof(out));
+  uint8_t decoded[50];
+  size_t decodedLen = fromBase58(encoded, strlen(encoded), decoded, sizeof(decoded));
+  result(hex, outLen == strlen(encoded) && strcmp(out, encoded) == 0 &&
+              decodedLen == len && memcmp(decoded, data, len) == 0);
+}
+
+// payload with a valid checksum, the same string with every character
+// replaced by another one should fail
+void testBase58Check(char * hex, char * encoded){
+  uint8_t data[50];
+  size_t len = fromHex(hex, strlen(hex), data, sizeof(data));
+  char out[100] = { 0 };
+  toBase58Check(data, len, out, sizeof(out));
+  uint8_t decoded[50];
+  size_t decodedLen = fromBase58Check(encoded, strlen(encoded), decoded, sizeof(decoded));
+  bool ok = strcmp(out, encoded) == 0 && decodedLen == len && memcmp(decoded, data, len) == 0;
+
+  char broken[100];
+  for(size_t i=0; i<strlen(encoded); i++){
+    strcpy(broken, encoded);
+    broken[i] = (broken[i] == '2') ? '3' : '2';
+    ok = ok && fromBase58Check(broken, strlen(broken), decoded, sizeof(decoded)) == 0;
+  }
+  result(encoded, ok);
+}
+
+void testInvalid(char * encoded){
+  uint8_t decoded[50];
+  result(encoded, fromBase58(encoded, strlen(encoded), decoded, sizeof(decoded)) == 0);
+}
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial){
+    ; // wait for serial port
+  }
+  testBase58("61", "2g");
+  testBase58("626262", "a3gV");
+  testBase58("636363", "aPEr");
+  testBase58("73696d706c792061206c6f6e6720737472696e67", "2cFupjhnEsSn59qHXstmK2ffpLv2");
+  testBase58("516b6fcd0f", "ABnLTmg");
+  testBase58("bf4f89001e670274dd", "3SEo3LWLoPntC");
+  testBase58("572e4794", "3EFU7m");
+  testBase58("ecac89cad93923c02321", "EJDM8drfXA6uyA");
+  testBase58("10c8511e", "Rt5zm");
+  // leading zeros are encoded as ones
+  testBase58("00eb15231dfceb60925886b67d065299925915aeb172c06647", "1NS17iag9jJgTHD1VXjvLCEnZuQ3rJDE9L");
+  testBase58("000000287fb4cd", "111233QC4");
+  // all zeros
+  testBase58("00", "1");
+  testBase58("00000000000000000000", "1111111111");
+
+  // genesis block address
+  testBase58Check("0062e907b15cbf27d5425399ebf6f0fb50ebb88f18", "1A1zP1eP5QGefi2DMPTfTL5SLmv7DivfNa");
+  testBase58Check("000000000000000000000000000000000000000000", "1111111111111111111114oLvT2");
+
+  // decoding stops at the first character outside of the alphabet
+  testInvalid("0OIl");
+  testInvalid("l2g");
+  testInvalid(" 2g");
+}
+
+void loop() {
+  // put your main code here, to run repeatedly:
+
+}
@@ -0,0 +1,122 @@
+#include <Bitcoin.h>
+#define VERBOSE false
+
+void result(bool ok){
+  if(ok){
+    Serial.println("OK. Test passed");
+  }else{
+    Serial.println("ERROR. Test failed");
+  }
+}
+
+// BIP173 / BIP350 valid checksums, decoded data is encoded back
+void testChecksum(char * str, bech32_encoding encoding){
+  char hrp[84];
+  uint8_t data[90];
+  size_t dataLen = 0;
+  bech32_encoding enc = bech32_decode(hrp, data, &dataLen, str);
+  char out[100] = { 0 };
+  char lower[100] = { 0 };
+  for(size_t i=0; i<strlen(str); i++){
+    lower[i] = tolower(str[i]);
+  }
+  if(enc == encoding){
+    bech32_encode(out, hrp, data, dataLen, encoding);
+  }
+  if(VERBOSE){
+    Serial.println(str);
+    Serial.println(out);
+  }
+  result(enc == encoding && strcmp(out, lower) == 0);
+}
+
+// valid addresses with their scriptPubKeys
+void testAddress(char * addr, char * hex){
+  char hrp[3] = { 0 };
+  char lower[100] = { 0 };
+  for(size_t i=0; i<strlen(addr); i++){
+    lower[i] = tolower(addr[i]);
+  }
+  memcpy(hrp, lower, 2);
+  int ver = -1;
+  uint8_t prog[40];
+  size_t progLen = 0;
+  int r = segwit_addr_decode(&ver, prog, &progLen, hrp, addr);
+
+  uint8_t expected[42];
+  size_t len = fromHex(hex, expected, sizeof(expected));
+  Script script(lower);
+  String encoded = script.address(hrp[0] == 't');
+  if(VERBOSE){
+    Serial.println(addr);
+    Serial.println(script);
+    Serial.println(encoded);
+  }
+  uint8_t version = (ver == 0) ? 0 : 0x50 + ver;
+  result(r == 1 && len == progLen + 2 &&
+         expected[0] == version && expected[1] == progLen &&
+         memcmp(expected+2, prog, progLen) == 0 &&
+         Script(expected, len) == script &&
+         encoded == lower);
+}
+
+// wrong checksum, version, padding, program length or hrp
+void testInvalidAddress(char * addr){
+  int ver;
+  uint8_t prog[40];
+  size_t progLen;
+  bool mainnet = segwit_addr_decode(&ver, prog, &progLen, "bc", addr);
+  bool testnet = segwit_addr_decode(&ver, prog, &progLen, "tb", addr);
+  if(VERBOSE){
+    Serial.println(addr);
+  }
+  result(!mainnet && !testnet);
+}
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial){
+    ; // wait for serial port
+  }
+  // BIP173 Bech32 checksums
+  testChecksum("A12UEL5L", BECH32_ENCODING_BECH32);
+  testChecksum("a12uel5l", BECH32_ENCODING_BECH32);
+  testChecksum("abcdef1qpzry9x8gf2tvdw0s3jn54khce6mua7lmqqqxw", BECH32_ENCODING_BECH32);
+  testChecksum("split1checkupstagehandshakeupstreamerranterredcaperred2y9e3w", BECH32_ENCODING_BECH32);
+  testChecksum("?1ezyfcl", BECH32_ENCODING_BECH32);
+  // BIP350 Bech32m checksums
+  testChecksum("split1checkupstagehandshakeupstreamerranterredcaperredlc445v", BECH32_ENCODING_BECH32M);
+  testChecksum("A1LQFN3A", BECH32_ENCODING_BECH32M);
+  testChecksum("a1lqfn3a", BECH32_ENCODING_BECH32M);
+  testChecksum("abcdef1l7aum6echk45nj3s0wdvt2fg8x9yrzpqzd3ryx", BECH32_ENCODING_BECH32M);
+  testChecksum("?1v759aa", BECH32_ENCODING_BECH32M);
+
+  // BIP350 addresses, witness v0 uses Bech32, v1+ use Bech32m
+  testAddress("BC1QW508D6QEJXTDG4Y5R3ZARVARY0C5XW7KV8F3T4", "0014751e76e8199196d454941c45d1b3a323f1433bd6");
+  testAddress("tb1qrp33g0q5c5txsp9arysrx4k6zdkfs4nce4xj0gdcccefvpysxf3q0sl5k7", "00201863143c14c5166804bd19203356da136c985678cd4d27a1b8c6329604903262");
+  testAddress("bc1pw508d6qejxtdg4y5r3zarvary0c5xw7kw508d6qejxtdg4y5r3zarvary0c5xw7kt5nd6y", "5128751e76e8199196d454941c45d1b3a323f1433bd6751e76e8199196d454941c45d1b3a323f1433bd6");
+  testAddress("BC1SW50QGDZ25J", "6002751e");
+  testAddress("bc1zw508d6qejxtdg4y5r3zarvaryvaxxpcs", "5210751e76e8199196d454941c45d1b3a323");
+  testAddress("tb1qqqqqp399et2xygdj5xreqhjjvcmzhxw4aywxecjdzew6hylgvsesrxh6hy", "0020000000c4a5cad46221b2a187905e5266362b99d5e91c6ce24d165dab93e86433");
+  testAddress("tb1pqqqqp399et2xygdj5xreqhjjvcmzhxw4aywxecjdzew6hylgvsesf3hn0c", "5120000000c4a5cad46221b2a187905e5266362b99d5e91c6ce24d165dab93e86433");
+  testAddress("bc1p0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vqzk5jj0", "512079be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798");
+
+  // v1 with Bech32 checksum and v0 with Bech32m checksum
+  testInvalidAddress("bc1p0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vqh2y7hd");
+  testInvalidAddress("tb1z0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vqglt7rf");
+  testInvalidAddress("BC1S0XLXVLHEMJA6C4DQV22UAPCTQUPFHLXM9H8Z3K2E72Q4K9HCZ7VQ54WELL");
+  testInvalidAddress("bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kemeawh");
+  // invalid hrp, program length, padding and empty data
+  testInvalidAddress("tc1p0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vq5zuyut");
+  testInvalidAddress("bc1gmk9yu");
+  testInvalidAddress("bc1pw5dgrnzv");
+  testInvalidAddress("1qqqqqqqq");
+  testInvalidAddress("qqqqqqqqqqqq");
+  // mixed case
+  testInvalidAddress("tb1qrp33g0q5c5txsp9arysrx4k6zdkfs4nce4xj0gdcccefvpysxf3q0sL5k7");
+}
+
+void loop() {
+  // put your main code here, to run repeatedly:
+
+}
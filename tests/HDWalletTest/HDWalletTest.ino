@@ -0,0 +1,126 @@
+#include <Bitcoin.h>
+#define VERBOSE false
+
+// BIP-32 test vector 1
+byte seed[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+HDPrivateKey root;
+HDPrivateKeyCache cache;
+
+void testDerive(char * path, char * xprv){
+  HDPrivateKey key = root.derive(path);
+  HDPrivateKey cached = root.derive(path, &cache);
+  if(VERBOSE){
+    Serial.println(path);
+    Serial.println(key);
+  }
+  if(key && key.xprv() == xprv && cached.xprv() == xprv){
+    Serial.println("OK. Test passed");
+  }else{
+    Serial.println("ERROR. Test failed");
+  }
+}
+
+void testInvalidPath(char * path){
+  HDPrivateKey key = root.derive(path);
+  HDPublicKey xpub = root.xpub().c_str();
+  HDPublicKey pub = xpub.derive(path);
+  if(VERBOSE){
+    Serial.println(path);
+  }
+  if(!key && !pub){
+    Serial.println("OK. Test passed");
+  }else{
+    Serial.println("ERROR. Test failed");
+  }
+}
+
+// the same root on another network shouldn't get keys cached for mainnet
+void testCacheNetwork(char * path){
+  HDPrivateKey testnetRoot;
+  testnetRoot.fromSeed(seed, sizeof(seed), true);
+  root.derive(path, &cache);
+  HDPrivateKey key = testnetRoot.derive(path);
+  HDPrivateKey cached = testnetRoot.derive(path, &cache);
+  if(VERBOSE){
+    Serial.println(path);
+    Serial.println(cached);
+  }
+  if(key && cached.xprv() == key.xprv() && cached.xprv().startsWith("tprv")){
+    Serial.println("OK. Test passed");
+  }else{
+    Serial.println("ERROR. Test failed");
+  }
+}
+
+// batch addresses should match the ones of single children,
+// base58 addresses use the smallest stride with room for the terminator
+void testAddresses(bool testnet, uint8_t type){
+  HDPrivateKey key;
+  key.fromSeed(seed, sizeof(seed), testnet);
+  HDPublicKey xpub = key.xpub().c_str();
+  size_t stride = (type == P2WPKH) ? 43 : 36;
+  char out[4*43];
+  int count = xpub.addresses(0, 4, out, stride, type);
+  bool ok = (count == 4);
+  for(int i=0; i<4; i++){
+    PublicKey pub = xpub.child(i).publicKey;
+    String expected;
+    if(type == P2WPKH){
+      expected = pub.segwitAddress(testnet);
+    }else if(type == P2SH_P2WPKH){
+      expected = pub.nestedSegwitAddress(testnet);
+    }else{
+      expected = pub.address(testnet);
+    }
+    if(VERBOSE){
+      Serial.println(out + i*stride);
+    }
+    ok = ok && (expected == out + i*stride);
+  }
+  // testnet P2SH addresses have 35 characters and don't fit into 35 bytes
+  if(testnet && type == P2SH_P2WPKH){
+    ok = ok && (xpub.addresses(0, 4, out, 35, type) == 0);
+    for(int i=0; i<4; i++){
+      ok = ok && (out[i*35] == 0);
+    }
+  }
+  if(ok){
+    Serial.println("OK. Test passed");
+  }else{
+    Serial.println("ERROR. Test failed");
+  }
+}
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial){
+    ; // wait for serial port
+  }
+  root.fromSeed(seed, sizeof(seed), false);
+
+  testDerive("m", "xprv9s21ZrQH143K3QTDL4LXw2F7HEK3wJUD2nW2nRk4stbPy6cq3jPPqjiChkVvvNKmPGJxWUtg6LnF5kejMRNNU3TGtRBeJgk33yuGBxrMPHi");
+  testDerive("m/0'", "xprv9uHRZZhk6KAJC1avXpDAp4MDc3sQKNxDiPvvkX8Br5ngLNv1TxvUxt4cV1rGL5hj6KCesnDYUhd7oWgT11eZG7XnxHrnYeSvkzY7d2bhkJ7");
+  testDerive("m/0'/1/2'/2/1000000000", "xprvA41z7zogVVwxVSgdKUHDy1SKmdb533PjDz7J6N6mV6uS3ze1ai8FHa8kmHScGpWmj4WggLyQjgPie1rFSruoUihUZREPSL39UNdE3BBDu76");
+  testDerive("m/0h/1/2H/2/1000000000", "xprvA41z7zogVVwxVSgdKUHDy1SKmdb533PjDz7J6N6mV6uS3ze1ai8FHa8kmHScGpWmj4WggLyQjgPie1rFSruoUihUZREPSL39UNdE3BBDu76");
+  testCacheNetwork("m/44'/0'/0'/0");
+  for(int testnet=0; testnet<2; testnet++){
+    testAddresses(testnet, P2PKH);
+    testAddresses(testnet, P2SH_P2WPKH);
+    testAddresses(testnet, P2WPKH);
+  }
+
+  // indexes don't fit into 31 bits
+  testInvalidPath("m/2147483648");
+  testInvalidPath("m/4294967296");
+  testInvalidPath("m/0/99999999999");
+  // broken syntax
+  testInvalidPath("m//1");
+  testInvalidPath("m/1/");
+  testInvalidPath("m/1x");
+}
+
+void loop() {
+  // put your main code here, to run repeatedly:
+
+}
@@ -0,0 +1,173 @@
+#include <Bitcoin.h>
+#include <OpCodes.h>
+#define VERBOSE false
+
+PrivateKey keys[3];
+Script multisig;
+SignatureCache cache(64);
+
+void check(const char * name, bool result, bool expected){
+  if(VERBOSE){
+    Serial.print(name);
+    Serial.print(": ");
+    Serial.println(result ? "valid" : "invalid");
+  }
+  if(result == expected){
+    Serial.println("OK. Test passed");
+  }else{
+    Serial.println("ERROR. Test failed");
+  }
+}
+
+// transaction with n inputs and one output, ready to be signed
+Transaction makeTransaction(size_t n){
+  Transaction tx;
+  for(size_t i=0; i<n; i++){
+    TransactionInput * txIn = tx.emplaceInput();
+    for(int j=0; j<32; j++){
+      txIn->hash[j] = i + j;
+    }
+    txIn->outputIndex = i;
+    txIn->amount = 10000 + i;
+  }
+  TransactionOutput * txOut = tx.emplaceOutput();
+  txOut->amount = 5000;
+  txOut->scriptPubKey = keys[0].publicKey().script(P2WPKH);
+  return tx;
+}
+
+// <len><der><SIGHASH_ALL>
+size_t signature(const PrivateKey &pk, const uint8_t hash[32], uint8_t * out){
+  size_t len = pk.sign(hash).der(out+1, 72);
+  out[0] = len + 1;
+  out[len+1] = SIGHASH_ALL;
+  return len + 2;
+}
+
+void testP2PKH(){
+  Transaction tx = makeTransaction(3);
+  for(int i=0; i<3; i++){
+    tx.signInput(i, keys[i]);
+  }
+  Script scriptPubKey = keys[1].publicKey().script(P2PKH);
+  check("P2PKH", tx.verifyInput(1, scriptPubKey), true);
+  check("P2PKH cached", tx.verifyInput(1, scriptPubKey, &cache), true);
+  check("P2PKH cache hit", tx.verifyInput(1, scriptPubKey, &cache), true);
+  check("P2PKH wrong key", tx.verifyInput(0, scriptPubKey), false);
+  // signatures commit to the locktime, a cached signature doesn't help
+  tx.locktime = 12345;
+  check("P2PKH locktime changed", tx.verifyInput(1, scriptPubKey, &cache), false);
+}
+
+void testP2WPKH(){
+  Transaction tx = makeTransaction(2);
+  Script redeemScript = keys[0].publicKey().script(P2WPKH);
+  // first input is nested in P2SH, the second one is native
+  // as the transaction is already segwit
+  tx.signInput(0, keys[0], redeemScript);
+  tx.signInput(1, keys[1]);
+  check("P2SH-P2WPKH", tx.verifyInput(0, redeemScript.scriptPubkey()), true);
+  check("P2WPKH", tx.verifyInput(1, keys[1].publicKey().script(P2WPKH)), true);
+  check("P2WPKH as P2PKH", tx.verifyInput(1, keys[1].publicKey().script(P2PKH)), false);
+  // segwit signatures commit to the amount
+  tx.txIns[0].amount++;
+  tx.clearSigHashCache();
+  check("P2SH-P2WPKH wrong amount", tx.verifyInput(0, redeemScript.scriptPubkey()), false);
+}
+
+void testMultisig(bool segwit, bool swapped, bool dummy){
+  Transaction tx = makeTransaction(1);
+  uint8_t script[120];
+  size_t scriptLen = multisig.serializeScript(script, sizeof(script));
+  uint8_t hash[32];
+  if(segwit){
+    tx.sigHashSegwit(0, multisig, hash);
+  }else{
+    tx.sigHash(0, multisig, hash);
+  }
+  uint8_t sig1[74], sig2[74];
+  size_t len1 = signature(keys[swapped ? 2 : 0], hash, sig1);
+  size_t len2 = signature(keys[swapped ? 0 : 2], hash, sig2);
+
+  Script scriptPubKey;
+  if(segwit){
+    // witness: <number of items> <empty dummy> <sig> <sig> <script>
+    Script witness;
+    witness.push(4);
+    witness.push(0);
+    witness.push(sig1, len1);
+    witness.push(sig2, len2);
+    witness.push(scriptLen);
+    witness.push(script, scriptLen);
+    tx.txIns[0].witnessProgram = witness;
+    uint8_t h[32];
+    sha256(script, scriptLen, h);
+    scriptPubKey.push(OP_0);
+    scriptPubKey.push(32);
+    scriptPubKey.push(h, 32);
+  }else{
+    Script scriptSig;
+    scriptSig.push(dummy ? OP_1 : OP_0);
+    scriptSig.push(sig1, len1);
+    scriptSig.push(sig2, len2);
+    scriptSig.push(OP_PUSHDATA1);
+    scriptSig.push(scriptLen);
+    scriptSig.push(script, scriptLen);
+    tx.txIns[0].scriptSig = scriptSig;
+    scriptPubKey = multisig.scriptPubkey();
+  }
+  check(segwit ? "P2WSH multisig" : "P2SH multisig",
+        tx.verifyInput(0, scriptPubKey), !swapped && !dummy);
+}
+
+// scriptSig and scriptPubKey without signatures, in hex
+void testScript(const char * scriptSig, const char * scriptPubKey, bool valid){
+  uint8_t sig[50], pub[50];
+  size_t sigLen = fromHex(scriptSig, strlen(scriptSig), sig, sizeof(sig));
+  size_t pubLen = fromHex(scriptPubKey, strlen(scriptPubKey), pub, sizeof(pub));
+  Transaction tx = makeTransaction(1);
+  tx.txIns[0].scriptSig = Script(sig, sigLen);
+  check(scriptPubKey, tx.verifyInput(0, Script(pub, pubLen)), valid);
+}
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial){
+    ; // wait for serial port
+  }
+  for(int i=0; i<3; i++){
+    uint8_t secret[32] = { 0 };
+    secret[0] = 0x11;
+    secret[31] = i + 1;
+    keys[i] = PrivateKey(secret);
+  }
+  // 2-of-3
+  multisig.push(OP_2);
+  for(int i=0; i<3; i++){
+    multisig.push(keys[i].publicKey());
+  }
+  multisig.push(OP_3);
+  multisig.push(OP_CHECKMULTISIG);
+
+  testP2PKH();
+  testP2WPKH();
+  testMultisig(false, false, false);
+  testMultisig(true, false, false);
+  // signatures in the wrong order and non-empty dummy (BIP147)
+  testMultisig(false, true, false);
+  testMultisig(true, true, false);
+  testMultisig(false, false, true);
+
+  testScript("5253", "935587", true);           // 2 3 | ADD 5 EQUAL
+  testScript("00", "6351670068", false);        // 0 | IF 1 ELSE 0 ENDIF
+  testScript("51", "6351670068", true);         // 1 | IF 1 ELSE 0 ENDIF
+  testScript("51", "63", false);                // unbalanced IF
+  testScript("51", "6a", false);                // RETURN
+  testScript("00", "63007e6851", false);        // disabled CAT in a skipped branch
+  testScript("4f", "8b0087", true);             // -1 | 1ADD 0 EQUAL
+}
+
+void loop() {
+  // put your main code here, to run repeatedly:
+
+}
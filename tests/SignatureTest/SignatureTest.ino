@@ -62,6 +62,55 @@ void testConstructors(char * hex, bool valid){
   }
 }
 
+// verification vectors are collected for the batch test
+PublicKey batchKeys[8];
+Signature batchSigs[8];
+byte batchHashes[8][32];
+bool batchExpected[8];
+size_t batchLen = 0;
+
+void testVerify(char * secHex, char * message, char * derHex, bool valid){
+  PublicKey pubkey(secHex);
+  Signature sig(derHex);
+  byte hash[32];
+  sha256(message, strlen(message), hash);
+  bool result = pubkey.verify(sig, hash);
+  batchKeys[batchLen] = pubkey;
+  batchSigs[batchLen] = sig;
+  memcpy(batchHashes[batchLen], hash, 32);
+  batchExpected[batchLen] = valid;
+  batchLen++;
+  if(VERBOSE){
+    Serial.println(pubkey);
+    Serial.println(message);
+    Serial.println(sig);
+    Serial.println(result ? "Signature is valid" : "Signature is invalid");
+  }
+  if(result == valid){
+    Serial.println("OK. Test passed");
+  }else{
+    Serial.println("ERROR. Test failed");
+  }
+}
+
+void testVerifyBatch(){
+  bool results[8];
+  size_t expected = 0;
+  size_t count = PublicKey::verifyBatch(batchKeys, batchSigs, batchHashes, batchLen, results);
+  bool ok = true;
+  for(size_t i = 0; i < batchLen; i++){
+    if(results[i] != batchExpected[i]){
+      ok = false;
+    }
+    expected += batchExpected[i];
+  }
+  if(ok && count == expected){
+    Serial.println("OK. Test passed");
+  }else{
+    Serial.println("ERROR. Test failed");
+  }
+}
+
 void setup() {
   Serial.begin(9600);
   while(!Serial){
@@ -91,6 +140,20 @@ void setup() {
   testConstructors(" ;;300d020449df86c1020501100cfb0d]]", true);  
   testConstructors("300d020449df86-c1020501100cfb0d", false);
   testConstructors("300d020449df86c1020501100cfb0dfee", true);
+
+  Serial.println("\nVerification test");
+  testVerify("02b153da4c9653a5dbc9e7ccfec91522020b0abdbf588bf104721e02c7340af21a", "hello world", "3045022100fdc7cad71b6af278b9102e119ada6d1bd38d01a3cffe7bc5260d05b930424fd00220207a2d813c9e7c1a57a645bf4120bd48f4fbfc5c985c789881d38632bdc8c128", true);
+  testVerify("04d10b32706f475ede5b71078bf0548e7639312b08207f3b383919908a70dcff985391e3b59164de236c11d54994a573d89be650aad4ea74db1cf39cda9b78eafc", "arduino-bitcoin", "3044022021c5a60a0664daa08e3d49556e923b93673ef3f4f920b334e689ae9d2ead3b99022069ff3c87fdd7cb9cea3f4950c874652c0b17ae12b3a40d8b3eefaeca6931ed6f", true);
+  testVerify("03e9858b6e48eb93d8f27aa76b60806298c4c7dd94077ad6c3ff97c44937888647", "secp256k1 endomorphism", "304402204267c3d49fb2b039a155fde269e2f24fc0bfe9b0449b8ab876ab2be426b4694702206cd3dbbce5aa3c65c9523bff8d4b9b7b38da1c2387ef8ccc72dcd78a5b5769f0", true);
+  // wrong message
+  testVerify("02b153da4c9653a5dbc9e7ccfec91522020b0abdbf588bf104721e02c7340af21a", "hello world!", "3045022100fdc7cad71b6af278b9102e119ada6d1bd38d01a3cffe7bc5260d05b930424fd00220207a2d813c9e7c1a57a645bf4120bd48f4fbfc5c985c789881d38632bdc8c128", false);
+  // wrong key
+  testVerify("03e9858b6e48eb93d8f27aa76b60806298c4c7dd94077ad6c3ff97c44937888647", "arduino-bitcoin", "3044022021c5a60a0664daa08e3d49556e923b93673ef3f4f920b334e689ae9d2ead3b99022069ff3c87fdd7cb9cea3f4950c874652c0b17ae12b3a40d8b3eefaeca6931ed6f", false);
+  // s replaced with n - s is still valid
+  testVerify("03e9858b6e48eb93d8f27aa76b60806298c4c7dd94077ad6c3ff97c44937888647", "secp256k1 endomorphism", "304502204267c3d49fb2b039a155fde269e2f24fc0bfe9b0449b8ab876ab2be426b46947022100932c24431a55c39a36adc40072b4648381d4c0c32759136f4cf5870274ded751", true);
+
+  Serial.println("\nBatch verification test");
+  testVerifyBatch();
 }
 
 void loop() {
@@ -0,0 +1,159 @@
+#include <Bitcoin.h>
+#define VERBOSE false
+
+#define INPUTS 5
+#define OUTPUTS 3
+
+Transaction tx;
+uint8_t raw[1000];
+size_t rawLen = 0;
+
+void result(const char * name, bool ok){
+  if(VERBOSE){
+    Serial.println(name);
+  }
+  if(ok){
+    Serial.println("OK. Test passed");
+  }else{
+    Serial.println("ERROR. Test failed");
+  }
+}
+
+// inputs with different script lengths, every input except
+// the third one has a witness with two items: i+1 bytes and 33 bytes
+void makeTransaction(){
+  uint8_t data[100];
+  for(int i=0; i<INPUTS; i++){
+    TransactionInput * txIn = tx.emplaceInput();
+    memset(txIn->hash, i, 32);
+    txIn->outputIndex = i;
+    txIn->sequence = 0xFFFFFFF0 + i;
+    memset(data, 0x10 + i, sizeof(data));
+    txIn->scriptSig = Script(data, 20 * i);
+    Script witness;
+    if(i == 2){
+      witness.push(0);
+    }else{
+      witness.push(2);
+      witness.push(i+1);
+      witness.push(data, i+1);
+      witness.push(33);
+      witness.push(data, 33);
+    }
+    txIn->witnessProgram = witness;
+  }
+  for(int i=0; i<OUTPUTS; i++){
+    TransactionOutput * txOut = tx.emplaceOutput();
+    txOut->amount = 1000 * (i+1);
+    memset(data, 0x40 + i, sizeof(data));
+    txOut->scriptPubKey = Script(data, 22 + 30 * i);
+  }
+  tx.locktime = 500000;
+  rawLen = tx.serialize(raw, sizeof(raw));
+}
+
+bool sameScript(ByteSpan span, const Script &script){
+  uint8_t buf[100];
+  size_t len = script.serializeScript(buf, sizeof(buf));
+  return span.len == len && memcmp(span.data, buf, len) == 0;
+}
+
+bool checkInput(const TransactionView &view, size_t i){
+  TransactionInputView in = view.input(i);
+  ByteSpan item0 = view.witnessItem(i, 0);
+  ByteSpan item1 = view.witnessItem(i, 1);
+  bool ok = (memcmp(in.hash, tx.txIns[i].hash, 32) == 0) &&
+            (in.outputIndex == tx.txIns[i].outputIndex) &&
+            (in.sequence == tx.txIns[i].sequence) &&
+            sameScript(in.scriptSig, tx.txIns[i].scriptSig) &&
+            sameScript(in.witness, tx.txIns[i].witnessProgram);
+  if(i == 2){
+    return ok && item0.len == 0 && item1.len == 0;
+  }
+  return ok && item0.len == i+1 && item0.data[0] == 0x10 + i && item1.len == 33;
+}
+
+bool checkOutput(const TransactionView &view, size_t i){
+  TransactionOutputView out = view.output(i);
+  return (out.amount == tx.txOuts[i].amount) &&
+         sameScript(out.scriptPubKey, tx.txOuts[i].scriptPubKey);
+}
+
+void testIds(){
+  TransactionView view(raw, rawLen);
+  uint8_t wtxHash[32];
+  uint8_t hash[32];
+  doubleSha(raw, rawLen, wtxHash);
+  view.witnessHash(hash);
+  bool ok = view.isValid() && view.isSegwit() && view.length() == rawLen &&
+            view.inputsNumber == INPUTS && view.outputsNumber == OUTPUTS &&
+            view.locktime == tx.locktime && view.version == tx.version;
+  result("txid", ok && view.id() == tx.id());
+  result("wtxid", ok && memcmp(hash, wtxHash, 32) == 0);
+
+  // without witness data both ids are the same
+  uint8_t legacy[1000];
+  Transaction stripped = tx;
+  for(int i=0; i<INPUTS; i++){
+    stripped.txIns[i].witnessProgram = Script();
+  }
+  size_t len = stripped.serialize(legacy, sizeof(legacy));
+  TransactionView legacyView(legacy, len);
+  uint8_t id[32];
+  uint8_t wid[32];
+  legacyView.id(id);
+  legacyView.witnessId(wid);
+  result("legacy ids", legacyView.isValid() && !legacyView.isSegwit() &&
+         legacyView.id() == tx.id() && memcmp(id, wid, 32) == 0);
+}
+
+void testOrder(){
+  TransactionView view(raw, rawLen);
+  bool ok = true;
+  for(size_t i=0; i<INPUTS; i++){
+    ok = ok && checkInput(view, i);
+  }
+  for(size_t i=0; i<OUTPUTS; i++){
+    ok = ok && checkOutput(view, i);
+  }
+  result("in order", ok);
+
+  ok = true;
+  for(size_t i=INPUTS; i>0; i--){
+    ok = ok && checkInput(view, i-1);
+  }
+  for(size_t i=OUTPUTS; i>0; i--){
+    ok = ok && checkOutput(view, i-1);
+  }
+  result("backwards", ok);
+
+  // out of range
+  ok = view.input(INPUTS).scriptSig.len == 0 && view.output(OUTPUTS).scriptPubKey.len == 0 &&
+       view.witnessItem(0, 2).len == 0 && view.witnessItem(INPUTS, 0).len == 0;
+  result("out of range", ok);
+}
+
+void testTruncated(){
+  bool ok = true;
+  for(size_t len=0; len<rawLen; len++){
+    TransactionView view(raw, len);
+    ok = ok && !view.isValid();
+  }
+  result("truncated", ok);
+}
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial){
+    ; // wait for serial port
+  }
+  makeTransaction();
+  testIds();
+  testOrder();
+  testTruncated();
+}
+
+void loop() {
+  // put your main code here, to run repeatedly:
+
+}